@@ -0,0 +1,139 @@
+// Approach Monitor Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, consumes samples published by the ranging service
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timebase.h"
+#include "ultrasonic.h"
+#include "approach.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint32_t historyMm[APPROACH_HISTORY];
+static uint32_t historyTime[APPROACH_HISTORY];
+static uint8_t historyCount = 0;
+static uint8_t historyHead = 0;
+static uint32_t lastSeq = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Forget the range history, call before each new move; the front sensor
+// is gated at APPROACH_GATE_MM until doneApproach()
+void initApproach()
+{
+    RANGE_SAMPLE sample;
+
+    historyCount = 0;
+    historyHead = 0;
+    lastSeq = getRange(RANGE_FRONT, &sample);
+    setProximityGate(RANGE_FRONT, APPROACH_GATE_MM);
+}
+
+void doneApproach()
+{
+    setProximityGate(RANGE_FRONT, 0);
+}
+
+// Least-squares range rate over the history in mm/s (negative when closing in)
+static int32_t rangeRate()
+{
+    int32_t t[APPROACH_HISTORY];
+    int32_t tSum = 0, dSum = 0;
+    int64_t sxx = 0, sxy = 0;
+    uint8_t newest = (historyHead + APPROACH_HISTORY - 1) % APPROACH_HISTORY;
+    uint8_t i;
+
+    if(historyCount < 3)
+        return 0;
+
+    for(i = 0; i < historyCount; i++)
+    {
+        t[i] = -(int32_t)((historyTime[newest] - historyTime[i]) / TICKS_PER_MS);
+        tSum += t[i];
+        dSum += (int32_t)historyMm[i];
+    }
+    for(i = 0; i < historyCount; i++)
+    {
+        int32_t dt = t[i] * historyCount - tSum;
+        int32_t dd = (int32_t)historyMm[i] * historyCount - dSum;
+        sxx += (int64_t)dt * dt;
+        sxy += (int64_t)dt * dd;
+    }
+    if(sxx == 0)
+        return 0;
+
+    return (sxy * 1000) / sxx;
+}
+
+// Update the history from the ranging service and decide whether to keep
+// going, slow down, or brake so the robot stops APPROACH_STANDOFF_MM short
+APPROACH_STATE checkApproach(APPROACH_INFO *info)
+{
+    RANGE_SAMPLE sample;
+    uint32_t seq = getRange(RANGE_FRONT, &sample);
+    int32_t closing, gap;
+    uint32_t stopping;
+
+    if(seq != lastSeq && sample.valid)
+    {
+        historyMm[historyHead] = sample.mm;
+        historyTime[historyHead] = sample.time;
+        historyHead = (historyHead + 1) % APPROACH_HISTORY;
+        if(historyCount < APPROACH_HISTORY)
+            historyCount++;
+    }
+    lastSeq = seq;
+
+    closing = -rangeRate();
+    if(closing < 0)
+        closing = 0;
+
+    // Range now, allowing for travel since the sample was taken
+    gap = (int32_t)sample.mm - APPROACH_STANDOFF_MM
+          - (int32_t)((closing * (int64_t)getRangeAgeUs(&sample)) / 1000000);
+    stopping = (closing * APPROACH_LATENCY_MS) / 1000
+               + ((uint32_t)closing * closing) / (2 * APPROACH_DECEL_MM_S2);
+
+    info->mm = sample.mm;
+    info->closingMmS = closing;
+    info->stoppingMm = stopping;
+
+    // The proximity gate saw nothing within APPROACH_GATE_MM after the last sample
+    if(getProximity(RANGE_FRONT) == PROXIMITY_CLEAR)
+    {
+        info->ttcMs = 0xFFFFFFFF;
+        return APPROACH_CLEAR;
+    }
+
+    if(gap <= 0)
+        info->ttcMs = 0;
+    else if(closing == 0)
+        info->ttcMs = 0xFFFFFFFF;
+    else
+        info->ttcMs = ((uint32_t)gap * 1000) / closing;
+
+    if(gap <= 0 || (int32_t)stopping >= gap)
+        return APPROACH_BRAKE;
+    if(info->ttcMs < APPROACH_SLOW_TTC_MS)
+        return APPROACH_SLOW;
+    return APPROACH_CLEAR;
+}
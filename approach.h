@@ -0,0 +1,56 @@
+// Approach Monitor Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, consumes samples published by the ranging service
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef APPROACH_H_
+#define APPROACH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define APPROACH_HISTORY 8                         // samples used for the range-rate fit
+#define APPROACH_STANDOFF_MM 200                   // distance to stop short of an obstacle
+#define APPROACH_DECEL_MM_S2 2000                  // braking deceleration of the robot
+#define APPROACH_LATENCY_MS 40                     // sensing plus actuation delay
+#define APPROACH_SLOW_TTC_MS 1500                  // slow down below this time-to-collision
+#define APPROACH_SLOW_SPEED 120                    // mm/s used while creeping in
+#define APPROACH_GATE_MM 1700                      // pings beyond this only report "clear"
+
+typedef enum _APPROACH_STATE
+{
+    APPROACH_CLEAR,
+    APPROACH_SLOW,
+    APPROACH_BRAKE
+} APPROACH_STATE;
+
+typedef struct _APPROACH_INFO
+{
+    uint32_t mm;                                   // latest range
+    int32_t closingMmS;                            // approach speed, positive when closing in
+    uint32_t ttcMs;                                // time until the standoff is reached, 0xFFFFFFFF if never
+    uint32_t stoppingMm;                           // distance needed to brake from closingMmS
+} APPROACH_INFO;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initApproach();
+void doneApproach();
+APPROACH_STATE checkApproach(APPROACH_INFO *info);
+
+#endif
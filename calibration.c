@@ -0,0 +1,219 @@
+// Motor Calibration Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Feed-forward tables kept in on-chip EEPROM
+// Sweeps drive the motors open loop through the control loop (Timer 4A)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "wait.h"
+#include "eeprom.h"
+#include "encoder.h"
+#include "control.h"
+#include "movement.h"
+#include "calibration.h"
+
+// EEPROM layout: magic word, then every curve packed two entries per word
+#define CAL_WORDS ((CAL_CURVES * CAL_POINTS + 1) / 2)
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+// PWM for speeds 0, CAL_SPEED_STEP, ... per curve, non-decreasing
+static uint16_t table[CAL_CURVES][CAL_POINTS];
+static bool eepromOk = false;                      // tables are kept in RAM only if false
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void saveCalibration()
+{
+    uint16_t *entries = &table[0][0];
+    uint32_t data;
+    uint8_t i;
+
+    if(!eepromOk)
+        return;
+    for(i = 0; i < CAL_WORDS; i++)
+    {
+        data = entries[i * 2];
+        if(i * 2 + 1 < CAL_CURVES * CAL_POINTS)
+            data |= (uint32_t)entries[i * 2 + 1] << 16;
+        if(readEeprom(EEPROM_CALIBRATION + 1 + i) != data)
+            writeEeprom(EEPROM_CALIBRATION + 1 + i, data);
+    }
+    writeEeprom(EEPROM_CALIBRATION, CAL_MAGIC);
+}
+
+// The straight line the control loop used before calibration, for every curve
+void resetCalibration()
+{
+    uint32_t pwm;
+    uint8_t c, k;
+
+    for(c = 0; c < CAL_CURVES; c++)
+    {
+        for(k = 0; k < CAL_POINTS; k++)
+        {
+            pwm = CONTROL_FF_OFFSET + ((CONTROL_FF_Q8 * k * CAL_SPEED_STEP) >> 8);
+            table[c][k] = pwm > CONTROL_PWM_MAX ? CONTROL_PWM_MAX : pwm;
+        }
+    }
+    saveCalibration();
+}
+
+// Load the tables from EEPROM, writing the defaults on first boot
+void initCalibration()
+{
+    uint16_t *entries = &table[0][0];
+    uint32_t data;
+    uint8_t i;
+
+    eepromOk = initEeprom();
+    if(!eepromOk || readEeprom(EEPROM_CALIBRATION) != CAL_MAGIC)
+    {
+        resetCalibration();
+        return;
+    }
+    for(i = 0; i < CAL_WORDS; i++)
+    {
+        data = readEeprom(EEPROM_CALIBRATION + 1 + i);
+        entries[i * 2] = data & 0xFFFF;
+        if(i * 2 + 1 < CAL_CURVES * CAL_POINTS)
+            entries[i * 2 + 1] = data >> 16;
+    }
+}
+
+// Feed-forward PWM for a wheel speed magnitude, interpolated between entries;
+// beyond the last entry the final segment is extended up to full duty
+uint32_t getFeedForward(uint8_t wheel, bool reverse, uint32_t mmS)
+{
+    const uint16_t *t = table[CAL_CURVE(wheel, reverse)];
+    uint32_t k = mmS / CAL_SPEED_STEP;
+    uint32_t frac = mmS % CAL_SPEED_STEP;
+    uint32_t pwm;
+
+    if(k >= CAL_POINTS - 1)
+    {
+        k = CAL_POINTS - 2;
+        frac = mmS - k * CAL_SPEED_STEP;
+    }
+    pwm = t[k] + (t[k+1] - t[k]) * frac / CAL_SPEED_STEP;
+    return pwm > CONTROL_PWM_MAX ? CONTROL_PWM_MAX : pwm;
+}
+
+uint16_t getCalibrationPoint(uint8_t curve, uint8_t point)
+{
+    return table[curve][point];
+}
+
+// Invert a sweep of steady speeds at ascending PWM into PWM at each table
+// speed. The speeds are made monotone first (running maximum) so a noisy
+// step can only flatten the curve, never fold it back; speeds the motor never
+// reached map to full duty.
+void fitCalibration(const uint16_t pwm[], const uint16_t speed[], uint8_t n, uint16_t out[CAL_POINTS])
+{
+    uint16_t mono[CAL_STEPS];
+    uint32_t s;
+    uint8_t i, k;
+
+    for(i = 0; i < n; i++)
+        mono[i] = (i > 0 && mono[i-1] > speed[i]) ? mono[i-1] : speed[i];
+
+    for(k = 0; k < CAL_POINTS; k++)
+    {
+        s = k == 0 ? CAL_MOVING_MMS : k * CAL_SPEED_STEP;
+        for(i = 0; i < n && mono[i] < s; i++);
+        if(i == n)
+            out[k] = CONTROL_PWM_MAX;
+        else if(i == 0)
+            out[k] = pwm[0];
+        else
+            out[k] = pwm[i-1] + (uint32_t)(pwm[i] - pwm[i-1]) * (s - mono[i-1]) / (mono[i] - mono[i-1]);
+        if(k > 0 && out[k] < out[k-1])
+            out[k] = out[k-1];
+    }
+}
+
+// Average of the speed estimator over the sample window
+static uint16_t measureSpeed(uint8_t wheel)
+{
+    uint32_t sum = 0;
+    uint8_t i;
+
+    for(i = 0; i < CAL_SAMPLES; i++)
+    {
+        sum += getWheelSpeed(wheel);
+        waitMicrosecond(CAL_SAMPLE_MS * 1000);
+    }
+    return sum / CAL_SAMPLES;
+}
+
+// One pivot sweep: the wheels turn opposite ways, so the robot spins in place
+// and both curves of the pass are measured together
+static void sweep(bool leftReverse, uint16_t pwm[CAL_STEPS], uint16_t speed[ENCODER_COUNT][CAL_STEPS])
+{
+    uint32_t duty;
+    uint8_t i;
+
+    for(i = 0; i < CAL_STEPS; i++)
+    {
+        duty = CAL_PWM_START + i * CAL_PWM_STEP;
+        pwm[i] = duty > CONTROL_PWM_MAX ? CONTROL_PWM_MAX : duty;
+        setOpenLoopPwm(leftReverse ? -pwm[i] : pwm[i], leftReverse ? pwm[i] : -pwm[i]);
+        waitMicrosecond(CAL_SETTLE_MS * 1000);
+        speed[ENCODER_LEFT][i] = measureSpeed(ENCODER_LEFT);
+        speed[ENCODER_RIGHT][i] = measureSpeed(ENCODER_RIGHT);
+    }
+}
+
+// Sweep every wheel and direction (two pivots, about 40 s with the robot
+// spinning in place), fit the tables and store them. Returns false and keeps
+// the old tables if a wheel never moved.
+bool runCalibration()
+{
+    uint16_t pwm[CAL_STEPS];
+    uint16_t speed[ENCODER_COUNT][CAL_STEPS];
+    uint16_t fit[CAL_CURVES][CAL_POINTS];
+    uint8_t pass, wheel, c, k;
+    bool leftReverse;
+
+    wakeMotors();
+    for(pass = 0; pass < 2; pass++)
+    {
+        leftReverse = pass == 1;
+        sweep(leftReverse, pwm, speed);
+        for(wheel = 0; wheel < ENCODER_COUNT; wheel++)
+        {
+            c = CAL_CURVE(wheel, wheel == ENCODER_LEFT ? leftReverse : !leftReverse);
+            if(speed[wheel][CAL_STEPS-1] < CAL_MOVING_MMS)
+            {
+                stop();
+                return false;
+            }
+            fitCalibration(pwm, speed[wheel], CAL_STEPS, fit[c]);
+        }
+    }
+    stop();
+
+    for(c = 0; c < CAL_CURVES; c++)
+        for(k = 0; k < CAL_POINTS; k++)
+            table[c][k] = fit[c][k];
+    saveCalibration();
+    return true;
+}
@@ -0,0 +1,53 @@
+// Motor Calibration Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Feed-forward tables kept in on-chip EEPROM
+// Sweeps drive the motors open loop through the control loop (Timer 4A)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef CALIBRATION_H_
+#define CALIBRATION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CAL_MAGIC 0x4D430001                       // "MC", layout version 1
+#define CAL_CURVES 4                               // left/right wheel, forward/reverse
+#define CAL_POINTS 11                              // table entries per curve
+#define CAL_SPEED_STEP 50                          // mm/s between entries, 0 to 500 mm/s
+#define CAL_MOVING_MMS 20                          // entry 0 (the deadband) is the PWM that reaches this speed
+#define CAL_PWM_START 384                          // sweep from well inside the deadband
+#define CAL_PWM_STEP 32
+#define CAL_STEPS 21                               // last step is clamped to full duty
+#define CAL_SETTLE_MS 400                          // wait for the wheel speed to settle
+#define CAL_SAMPLES 20                             // speed samples averaged per step
+#define CAL_SAMPLE_MS 10
+
+#define CAL_CURVE(wheel, reverse) ((wheel) * 2 + ((reverse) ? 1 : 0))
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initCalibration();
+void resetCalibration();
+bool runCalibration();
+uint32_t getFeedForward(uint8_t wheel, bool reverse, uint32_t mmS);
+uint16_t getCalibrationPoint(uint8_t curve, uint8_t point);
+
+// Hardware independent fit, driven by runCalibration (or a motor model on a host)
+void fitCalibration(const uint16_t pwm[], const uint16_t speed[], uint8_t n, uint16_t table[CAL_POINTS]);
+
+#endif
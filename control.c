@@ -0,0 +1,208 @@
+// Wheel Speed Control Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Right motor on M0PWM6 (PC4, reverse) and M0PWM7 (PC5, forward)
+// Left motor on M1PWM0 (PD0, forward) and M1PWM1 (PD1, reverse)
+// Timer 4A: periodic control loop interrupt
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "encoder.h"
+#include "control.h"
+#include "profile.h"
+#include "segment.h"
+#include "movement.h"
+#include "calibration.h"
+#include "motor.h"
+#include "odometry.h"
+
+typedef struct _WHEEL_CONTROL
+{
+    volatile int32_t target;                       // mm/s, sign is direction
+    int32_t integral;                              // PWM (Q8)
+} WHEEL_CONTROL;
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static WHEEL_CONTROL wheels[ENCODER_COUNT];
+static uint32_t headingBase[ENCODER_COUNT];        // encoder counts when the move started
+static volatile bool openLoop = false;             // PWM set directly, for calibration sweeps
+static volatile int32_t openPwm[ENCODER_COUNT];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Start the periodic control loop, the PWM generators must already be running
+void initControl()
+{
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R4;
+    _delay_cycles(3);
+
+    TIMER4_CTL_R &= ~TIMER_CTL_TAEN;                 // turn-off timer before reconfiguring
+    TIMER4_CFG_R = TIMER_CFG_32_BIT_TIMER;           // configure as 32-bit timer (A+B)
+    TIMER4_TAMR_R = TIMER_TAMR_TAMR_PERIOD;          // configure for periodic mode (count down)
+    TIMER4_TAILR_R = 40000000 / CONTROL_HZ;          // set load value for the loop rate
+    TIMER4_ICR_R = TIMER_ICR_TATOCINT;
+    TIMER4_IMR_R = TIMER_IMR_TATOIM;
+    NVIC_PRI17_R = (NVIC_PRI17_R & ~0x00E00000) | (1 << 21); // interrupt 86 at priority 1, below the encoder edges
+    NVIC_EN2_R = 1 << (INT_TIMER4A-16-64);           // turn-on interrupt 86 (TIMER4A)
+    TIMER4_CTL_R |= TIMER_CTL_TAEN;                  // turn-on timer
+}
+
+// Target wheel speeds in mm/s, negative runs the wheel backwards
+void setWheelSpeeds(int32_t leftMmS, int32_t rightMmS)
+{
+    wheels[ENCODER_LEFT].target = leftMmS;
+    wheels[ENCODER_RIGHT].target = rightMmS;
+}
+
+// Setpoint of one wheel in mm/s, positive is forward
+int32_t getWheelTarget(uint8_t wheel)
+{
+    return wheels[wheel].target;
+}
+
+// Start a new move for heading hold, both wheels count from here
+void resetHeading()
+{
+    headingBase[ENCODER_LEFT] = getEncoderCount(ENCODER_LEFT);
+    headingBase[ENCODER_RIGHT] = getEncoderCount(ENCODER_RIGHT);
+}
+
+// Zero the targets and outputs, also safe from the edge ISRs
+void stopControl()
+{
+    uint8_t i;
+
+    stopProfile();
+    openLoop = false;
+    __asm(" CPSID I");
+    for(i = 0; i < ENCODER_COUNT; i++)
+    {
+        wheels[i].target = 0;
+        wheels[i].integral = 0;
+        stageMotor(i, 0);
+    }
+    commitMotors();
+    __asm(" CPSIE I");
+}
+
+// Bypass the speed loop and hold fixed duties until stopControl()
+void setOpenLoopPwm(int32_t left, int32_t right)
+{
+    openPwm[ENCODER_LEFT] = left;
+    openPwm[ENCODER_RIGHT] = right;
+    openLoop = true;
+}
+
+// PI on speed magnitude with calibrated feed-forward; the integrator is frozen
+// while the output is saturated in the direction of the error (anti-windup)
+static int32_t updateWheel(uint8_t wheel, int32_t trim)
+{
+    WHEEL_CONTROL *w = &wheels[wheel];
+    int32_t target = w->target;
+    int32_t magnitude = target < 0 ? -target : target;
+    int32_t error, integral, out;
+
+    if(target == 0)
+    {
+        w->integral = 0;
+        return 0;
+    }
+
+    magnitude += trim;
+    if(magnitude < 0)
+        magnitude = 0;
+    error = magnitude - (int32_t)getWheelSpeed(wheel);
+    integral = w->integral + CONTROL_KI_Q8 * error;
+    if(integral > CONTROL_INTEGRAL_MAX)
+        integral = CONTROL_INTEGRAL_MAX;
+    if(integral < -CONTROL_INTEGRAL_MAX)
+        integral = -CONTROL_INTEGRAL_MAX;
+
+    out = getFeedForward(wheel, target < 0, magnitude) + ((CONTROL_KP_Q8 * error + integral) >> 8);
+    if(out > CONTROL_PWM_MAX)
+    {
+        out = CONTROL_PWM_MAX;
+        if(error < 0)
+            w->integral = integral;
+    }
+    else if(out < 0)
+    {
+        out = 0;
+        if(error > 0)
+            w->integral = integral;
+    }
+    else
+        w->integral = integral;
+
+    return target < 0 ? -out : out;
+}
+
+// Cross-coupling for straight runs and pivots: when both wheels are asked
+// for the same speed, the wheel that has counted ahead is slowed and the
+// other sped up until the counts match again
+static int32_t getHeadingTrim()
+{
+    int32_t left = wheels[ENCODER_LEFT].target;
+    int32_t right = wheels[ENCODER_RIGHT].target;
+    int32_t trim;
+
+    if(left == 0 || (left != right && left != -right))
+        return 0;
+    trim = HEADING_GAIN * (int32_t)((getEncoderCount(ENCODER_LEFT) - headingBase[ENCODER_LEFT])
+                                    - (getEncoderCount(ENCODER_RIGHT) - headingBase[ENCODER_RIGHT]));
+    if(trim > HEADING_TRIM_MAX)
+        trim = HEADING_TRIM_MAX;
+    if(trim < -HEADING_TRIM_MAX)
+        trim = -HEADING_TRIM_MAX;
+    return trim;
+}
+
+void ControlIsr()
+{
+    int32_t trim, left, right;
+
+    TIMER4_ICR_R = TIMER_ICR_TATOCINT;
+    sampleEncoders();
+    updateMoveLimit();
+    if(openLoop)
+    {
+        updateOdometry(openPwm[ENCODER_LEFT], openPwm[ENCODER_RIGHT]); // the duty signs give the wheel directions
+        setMotors(openPwm[ENCODER_LEFT], openPwm[ENCODER_RIGHT]);
+        return;
+    }
+    updateSegments();
+    updateProfile();
+    updateOdometry(wheels[ENCODER_LEFT].target, wheels[ENCODER_RIGHT].target);
+    if(updateStop())
+        return;                                      // the stop sequence drives the bridge
+    trim = getHeadingTrim();                         // positive when the left wheel is ahead
+    left = updateWheel(ENCODER_LEFT, -trim);
+    right = updateWheel(ENCODER_RIGHT, trim);
+    __asm(" CPSID I");                               // an encoder edge may have started a stop since
+    if(!isStopping())
+    {
+        stageMotor(ENCODER_LEFT, left);
+        stageMotor(ENCODER_RIGHT, right);
+        commitMotors();                              // both wheels change on the same PWM period
+    }
+    __asm(" CPSIE I");
+}
@@ -0,0 +1,48 @@
+// Wheel Speed Control Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Right motor on M0PWM6 (PC4, reverse) and M0PWM7 (PC5, forward)
+// Left motor on M1PWM0 (PD0, forward) and M1PWM1 (PD1, reverse)
+// Timer 4A: periodic control loop interrupt
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef CONTROL_H_
+#define CONTROL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CONTROL_HZ 200                             // loop rate, well above the encoder edge rate
+#define CONTROL_PWM_MAX 1023                       // PWM load is 1024
+#define CONTROL_FF_OFFSET 700                      // uncalibrated feed-forward: PWM where the wheels start to turn
+#define CONTROL_FF_Q8 184                          // and PWM per mm/s (Q8), 1023 at ~450 mm/s
+#define CONTROL_KP_Q8 128                          // PWM per mm/s of error (Q8)
+#define CONTROL_KI_Q8 3                            // PWM per mm/s of error per sample (Q8)
+#define CONTROL_INTEGRAL_MAX (300 << 8)            // integrator limit in PWM (Q8)
+#define HEADING_GAIN 20                            // mm/s of setpoint trim per count of left/right mismatch
+#define HEADING_TRIM_MAX 60                        // trim limit in mm/s
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initControl();
+void setWheelSpeeds(int32_t leftMmS, int32_t rightMmS);
+int32_t getWheelTarget(uint8_t wheel);
+void stopControl();
+void setOpenLoopPwm(int32_t left, int32_t right);
+void resetHeading();
+
+#endif
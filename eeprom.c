@@ -0,0 +1,52 @@
+// EEPROM Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// On-chip EEPROM, 2 KB as 32 blocks of 16 words
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "eeprom.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Initialize the EEPROM, returns false if an interrupted write could not be recovered
+bool initEeprom()
+{
+    SYSCTL_RCGCEEPROM_R |= SYSCTL_RCGCEEPROM_R0;
+    _delay_cycles(6);
+    while(EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
+    return !(EEPROM_EESUPP_R & (EEPROM_EESUPP_PRETRY | EEPROM_EESUPP_ERETRY));
+}
+
+// Read one 32-bit word
+uint32_t readEeprom(uint16_t add)
+{
+    EEPROM_EEBLOCK_R = add >> 4;
+    EEPROM_EEOFFSET_R = add & 0xF;
+    return EEPROM_EERDWR_R;
+}
+
+// Write one 32-bit word, blocks until it is programmed (skip unchanged words to save wear)
+void writeEeprom(uint16_t add, uint32_t data)
+{
+    EEPROM_EEBLOCK_R = add >> 4;
+    EEPROM_EEOFFSET_R = add & 0xF;
+    EEPROM_EERDWR_R = data;
+    while(EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
+}
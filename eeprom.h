@@ -0,0 +1,39 @@
+// EEPROM Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// On-chip EEPROM, 2 KB as 32 blocks of 16 words
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef EEPROM_H_
+#define EEPROM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EEPROM_WORDS 512
+
+// Word address map, one region per user
+#define EEPROM_KEYMAP 0                            // IR keymap, 1 + 256 words
+#define EEPROM_CALIBRATION 257                     // motor feed-forward tables, 1 + 22 words
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+bool initEeprom();
+uint32_t readEeprom(uint16_t add);
+void writeEeprom(uint16_t add, uint32_t data);
+
+#endif
@@ -0,0 +1,301 @@
+// Wheel Encoder Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Left collector on (PC7), right collector on (PD6), one falling edge per slot
+// Edges are timestamped from the timebase (Wide Timer 5A)
+// Hardware counting: left on WT1CCP1 (PC7) in edge-count mode,
+//                    right on QEI0 PhA (PD6) in clock/direction mode
+// The edge counter has no input filter, so both counts go through the same
+// speed-adaptive lockout as the software path when they are sampled
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "timebase.h"
+#include "encoder.h"
+
+#define LEFT_COLLECTOR_MASK 128                    // PC7
+#define RIGHT_COLLECTOR_MASK 64                    // PD6
+
+typedef struct _ENCODER
+{
+    volatile uint32_t edge[ENCODER_HISTORY];       // timestamps of the most recent edges
+    volatile uint32_t count;                       // edges since boot
+    volatile uint32_t seq;                         // odd while the ISR is writing
+    bool suppressed;                               // the lockout after the last edge hid an edge
+    ENCODER_STATS stats;
+} ENCODER;
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static ENCODER encoders[ENCODER_COUNT];
+#if !ENCODER_SOFTWARE_COUNT
+static uint32_t lastSample;                        // timebase ticks of the previous sample
+static uint32_t lastHw[ENCODER_COUNT];             // hardware counts at the previous sample
+#endif
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Route the collectors to the counting peripherals; with software counting
+// the edge ISRs in the movement library do the counting instead
+void initEncoders()
+{
+    resetEncoderStats();
+#if !ENCODER_SOFTWARE_COUNT
+    SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R2 | SYSCTL_RCGCGPIO_R3;
+    SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R1;
+    SYSCTL_RCGCQEI_R |= SYSCTL_RCGCQEI_R0;
+    _delay_cycles(3);
+
+    // Left collector: Wide Timer 1B counts falling edges
+    GPIO_PORTC_IM_R &= ~LEFT_COLLECTOR_MASK;
+    GPIO_PORTC_AFSEL_R |= LEFT_COLLECTOR_MASK;
+    GPIO_PORTC_PCTL_R &= ~GPIO_PCTL_PC7_M;
+    GPIO_PORTC_PCTL_R |= GPIO_PCTL_PC7_WT1CCP1;
+
+    WTIMER1_CTL_R &= ~TIMER_CTL_TBEN;                // turn-off timer before reconfiguring
+    WTIMER1_CFG_R = 4;                               // configure as 32-bit timer (B only)
+    WTIMER1_TBMR_R = TIMER_TBMR_TBMR_CAP | TIMER_TBMR_TBCDIR; // edge-count mode, count up
+    WTIMER1_CTL_R = TIMER_CTL_TBEVENT_NEG;           // count falling edges, as the software path does
+    WTIMER1_TBILR_R = 0xFFFFFFFF;
+    WTIMER1_TBMATCHR_R = 0xFFFFFFFF;                 // never stop on a match, wrap at 32 bits
+    WTIMER1_IMR_R = 0;                               // no interrupts, sampled by the control loop
+    WTIMER1_CTL_R |= TIMER_CTL_TBEN;                 // turn-on timer
+
+    // Right collector: QEI0 with PhA as the clock and PhB (not routed) as the direction
+    GPIO_PORTD_IM_R &= ~RIGHT_COLLECTOR_MASK;
+    GPIO_PORTD_AFSEL_R |= RIGHT_COLLECTOR_MASK;
+    GPIO_PORTD_PCTL_R &= ~GPIO_PCTL_PD6_M;
+    GPIO_PORTD_PCTL_R |= GPIO_PCTL_PD6_PHA0;
+
+    QEI0_CTL_R = 0;                                  // turn-off QEI before reconfiguring
+    QEI0_MAXPOS_R = 0xFFFFFFFF;                      // wrap at 32 bits like the edge counter
+    QEI0_POS_R = 0;
+    QEI0_INTEN_R = 0;
+    QEI0_CTL_R = QEI_CTL_SIGMODE | QEI_CTL_INVA      // count falling edges of PhA
+               | QEI_CTL_FILTEN | (ENCODER_QEI_FILTER << QEI_CTL_FILTCNT_S)
+               | QEI_CTL_ENABLE;
+
+    lastHw[ENCODER_LEFT] = WTIMER1_TBR_R;
+    lastHw[ENCODER_RIGHT] = QEI0_POS_R;
+    lastSample = getTicks();
+#endif
+}
+
+// Record one collector edge, called from the edge ISRs. If the lockout after
+// the previous edge hid an edge and this interval is about twice the one
+// before, the hidden edge was real: it is stamped halfway and credited.
+// Returns the number of edges counted (1, or 2 with a recovered edge).
+uint32_t encoderEdge(uint8_t wheel, uint32_t ticks)
+{
+    ENCODER *e = &encoders[wheel];
+    uint32_t last, period, gap;
+    uint32_t edges = 1;
+
+    e->seq++;
+    if(e->count >= 2)
+    {
+        last = e->edge[(e->count - 1) & (ENCODER_HISTORY-1)];
+        period = last - e->edge[(e->count - 2) & (ENCODER_HISTORY-1)];
+        gap = ticks - last;
+        if(e->suppressed && gap > period + period / 2 && gap < period * 3)
+        {
+            e->edge[e->count & (ENCODER_HISTORY-1)] = last + gap / 2;
+            e->count++;
+            e->stats.bounces--;
+            e->stats.lost++;
+            gap /= 2;
+            edges = 2;
+        }
+        if(gap < ENCODER_DEBOUNCE_MAX_US * TICKS_PER_US && gap / TICKS_PER_US < e->stats.minGapUs)
+            e->stats.minGapUs = gap / TICKS_PER_US;
+    }
+    e->edge[e->count & (ENCODER_HISTORY-1)] = ticks;
+    e->count++;
+    e->suppressed = false;
+    e->seq++;
+    return edges;
+}
+
+// Median of the last three edge periods, so a single short interval from
+// a bounce that got through cannot shrink the lockout after it
+static uint32_t getMedianPeriod(const ENCODER *e)
+{
+    uint32_t a = e->edge[(e->count - 1) & (ENCODER_HISTORY-1)] - e->edge[(e->count - 2) & (ENCODER_HISTORY-1)];
+    uint32_t b = e->edge[(e->count - 2) & (ENCODER_HISTORY-1)] - e->edge[(e->count - 3) & (ENCODER_HISTORY-1)];
+    uint32_t c = e->edge[(e->count - 3) & (ENCODER_HISTORY-1)] - e->edge[(e->count - 4) & (ENCODER_HISTORY-1)];
+    uint32_t lo = a < b ? a : b;
+    uint32_t hi = a < b ? b : a;
+
+    return c < lo ? lo : c > hi ? hi : c;
+}
+
+// Lockout to arm after an edge: a fraction of the shorter of the commanded
+// and the median measured edge period, never below the bounce floor. A fixed
+// 25 ms window capped the count rate at 40 edges/s (490 mm/s) and lost
+// edges above it.
+uint32_t getDebounceTicks(uint8_t wheel, uint32_t commandedMmS)
+{
+    ENCODER *e = &encoders[wheel];
+    uint32_t period = ENCODER_DEBOUNCE_MAX_US * TICKS_PER_US << ENCODER_DEBOUNCE_SHIFT;
+    uint32_t measured, window;
+
+    if(commandedMmS != 0 && ENCODER_SPEED_K / commandedMmS < period)
+        period = ENCODER_SPEED_K / commandedMmS;
+    if(e->count >= 4)
+    {
+        measured = getMedianPeriod(e);
+        if(measured < period)
+            period = measured;
+    }
+    window = period >> ENCODER_DEBOUNCE_SHIFT;
+    if(window < ENCODER_DEBOUNCE_FLOOR_US * TICKS_PER_US)
+        window = ENCODER_DEBOUNCE_FLOOR_US * TICKS_PER_US;
+    if(window > ENCODER_DEBOUNCE_MAX_US * TICKS_PER_US)
+        window = ENCODER_DEBOUNCE_MAX_US * TICKS_PER_US;
+    e->stats.windowUs = window / TICKS_PER_US;
+    return window;
+}
+
+// An edge arrived while the lockout was armed, called from the debounce ISRs
+void encoderBounce(uint8_t wheel)
+{
+    encoders[wheel].suppressed = true;
+    encoders[wheel].stats.bounces++;
+}
+
+void getEncoderStats(uint8_t wheel, ENCODER_STATS *stats)
+{
+    *stats = encoders[wheel].stats;
+}
+
+void resetEncoderStats()
+{
+    uint8_t i;
+
+    for(i = 0; i < ENCODER_COUNT; i++)
+    {
+        encoders[i].stats.bounces = 0;
+        encoders[i].stats.lost = 0;
+        encoders[i].stats.minGapUs = 0xFFFFFFFF;
+    }
+}
+
+// Bring the edge history up to the hardware counters, called from the control
+// loop. Edges that arrived since the previous sample are spread evenly across
+// the interval, so a stamp is at most half a control period off. More edges
+// than the lockout allows in the interval are bounce and are dropped.
+void sampleEncoders()
+{
+#if !ENCODER_SOFTWARE_COUNT
+    uint32_t now = getTicks();
+    uint32_t interval = now - lastSample;
+    uint32_t hw[ENCODER_COUNT];
+    uint32_t n, k, window, start;
+    uint8_t wheel;
+    ENCODER *e;
+
+    hw[ENCODER_LEFT] = WTIMER1_TBR_R;
+    hw[ENCODER_RIGHT] = QEI0_POS_R;
+    for(wheel = 0; wheel < ENCODER_COUNT; wheel++)
+    {
+        e = &encoders[wheel];
+        n = hw[wheel] - lastHw[wheel];
+        lastHw[wheel] = hw[wheel];
+        if(n == 0)
+            continue;
+        // Edges a lockout apart that fit between the end of the previous
+        // edge's lockout (or the previous sample) and now
+        window = getDebounceTicks(wheel, 0);
+        start = e->count ? e->edge[(e->count - 1) & (ENCODER_HISTORY-1)] + window : lastSample;
+        if((int32_t)(start - lastSample) < 0)
+            start = lastSample;
+        k = (int32_t)(now - start) <= 0 ? 0 : (now - start - 1) / window + 1;
+        if(n > k)
+        {
+            e->stats.bounces += n - k;
+            n = k;
+        }
+        e->seq++;
+        k = n > ENCODER_HISTORY ? n - ENCODER_HISTORY : 0;
+        for(k++; k <= n; k++)
+            e->edge[(e->count + k - 1) & (ENCODER_HISTORY-1)] = lastSample + interval / (n + 1) * k;
+        e->count += n;
+        e->seq++;
+    }
+    lastSample = now;
+#endif
+}
+
+// Consistent copy of one wheel's history without masking the edge ISRs
+static void readEncoder(uint8_t wheel, ENCODER *copy)
+{
+    ENCODER *e = &encoders[wheel];
+    uint32_t seq;
+    uint8_t i;
+
+    do
+    {
+        seq = e->seq;
+        for(i = 0; i < ENCODER_HISTORY; i++)
+            copy->edge[i] = e->edge[i];
+        copy->count = e->count;
+    } while((seq & 1) || seq != e->seq);
+}
+
+uint32_t getEncoderCount(uint8_t wheel)
+{
+    return encoders[wheel].count;
+}
+
+// Wheel speed in mm/s (magnitude, the collectors have no direction). The
+// last edge period resolves low speeds; averaging over every edge inside the
+// window smooths slot-spacing jitter at high speed. The two are blended by
+// how many edges the window holds, and the period estimate decays while no
+// new edge arrives so a stalled wheel reads zero.
+uint32_t getWheelSpeed(uint8_t wheel)
+{
+    ENCODER e;
+    uint32_t now, last, since, period, span;
+    uint32_t periodSpeed, windowSpeed;
+    uint32_t n;
+
+    readEncoder(wheel, &e);
+    now = getTicks();
+    if(e.count < 2)
+        return 0;
+    last = e.edge[(e.count - 1) & (ENCODER_HISTORY-1)];
+    since = now - last;
+    if(since > ENCODER_STOPPED_MS * TICKS_PER_MS)
+        return 0;
+
+    period = last - e.edge[(e.count - 2) & (ENCODER_HISTORY-1)];
+    periodSpeed = ENCODER_SPEED_K / (since > period ? since : period);
+
+    // Intervals ending at the last edge that started inside the window
+    n = 1;
+    while(n < ENCODER_HISTORY - 1 && n + 1 < e.count
+          && now - e.edge[(e.count - 2 - n) & (ENCODER_HISTORY-1)] <= ENCODER_WINDOW_MS * TICKS_PER_MS)
+        n++;
+    span = last - e.edge[(e.count - 1 - n) & (ENCODER_HISTORY-1)];
+    windowSpeed = ENCODER_SPEED_K * n / span;
+
+    return (periodSpeed * (ENCODER_HISTORY - 1 - n) + windowSpeed * n) / (ENCODER_HISTORY - 1);
+}
@@ -0,0 +1,73 @@
+// Wheel Encoder Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Left collector on (PC7), right collector on (PD6), one falling edge per slot
+// Edges are timestamped from the timebase (Wide Timer 5A)
+// Hardware counting: left on WT1CCP1 (PC7) in edge-count mode,
+//                    right on QEI0 PhA (PD6) in clock/direction mode
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef ENCODER_H_
+#define ENCODER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timebase.h"
+
+// Count collector edges with GPIO interrupts instead of the counting peripherals
+#ifndef ENCODER_SOFTWARE_COUNT
+#define ENCODER_SOFTWARE_COUNT 0
+#endif
+
+#define ENCODER_LEFT 0
+#define ENCODER_RIGHT 1
+#define ENCODER_COUNT 2
+
+#define ENCODER_EDGES_PER_REV 20                   // slots in the encoder disk
+#define WHEEL_CIRCUMFERENCE_MM 245
+#define ENCODER_HISTORY 8                          // edge timestamps kept per wheel, power of two
+#define ENCODER_WINDOW_MS 100                      // edges older than this are left out of the average
+#define ENCODER_STOPPED_MS 300                     // no edge for this long reads as stopped
+#define ENCODER_QEI_FILTER 15                      // QEI input must hold for FILTCNT + 2 clocks
+#define ENCODER_DEBOUNCE_FLOOR_US 1500             // collector bounce settles within this
+#define ENCODER_DEBOUNCE_MAX_US 25000              // lockout when stopped, the old fixed window
+#define ENCODER_DEBOUNCE_SHIFT 1                   // lockout is 1/2 of the expected edge period
+
+// mm/s = ENCODER_SPEED_K * edges / ticks (4.9e8, times ENCODER_HISTORY still fits 32 bits)
+#define ENCODER_SPEED_K ((uint32_t)WHEEL_CIRCUMFERENCE_MM * (TICKS_PER_MS * 1000 / ENCODER_EDGES_PER_REV))
+
+typedef struct _ENCODER_STATS
+{
+    uint32_t bounces;                              // edges suppressed inside the lockout
+    uint32_t lost;                                 // suppressed edges that turned out to be real
+    uint32_t windowUs;                             // lockout armed after the last edge
+    uint32_t minGapUs;                             // shortest accepted edge interval
+} ENCODER_STATS;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initEncoders();
+uint32_t encoderEdge(uint8_t wheel, uint32_t ticks);
+uint32_t getDebounceTicks(uint8_t wheel, uint32_t commandedMmS);
+void encoderBounce(uint8_t wheel);
+void getEncoderStats(uint8_t wheel, ENCODER_STATS *stats);
+void resetEncoderStats();
+void sampleEncoders();
+uint32_t getEncoderCount(uint8_t wheel);
+uint32_t getWheelSpeed(uint8_t wheel);
+
+#endif
@@ -0,0 +1,168 @@
+// Sample Filter Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, filters are pure integer code with caller-owned state
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "filter.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Index of the first sorted entry not less than value (binary search)
+static uint8_t lowerBound(const uint32_t *sorted, uint8_t count, uint32_t value)
+{
+    uint8_t lo = 0;
+    uint8_t hi = count;
+
+    while(lo < hi)
+    {
+        uint8_t mid = (lo + hi) >> 1;
+        if(sorted[mid] < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void initMedianFilter(MEDIAN_FILTER *filter, uint8_t size)
+{
+    if(size == 0)
+        size = 1;
+    if(size > FILTER_MAX_WINDOW)
+        size = FILTER_MAX_WINDOW;
+
+    filter->size = size;
+    filter->count = 0;
+    filter->head = 0;
+}
+
+// Add a sample and return the new median. Binary search finds both slots,
+// but the oldest sample is removed and the new one inserted by shifting the
+// entries between them, so a sample costs O(N): at most size-1 word moves,
+// 8 with FILTER_MAX_WINDOW 9. At that size the shift beats the bookkeeping
+// of a two-heap or skip-list median.
+uint32_t medianFilter(MEDIAN_FILTER *filter, uint32_t sample)
+{
+    uint8_t from, to;
+
+    if(filter->count < filter->size)
+    {
+        to = lowerBound(filter->sorted, filter->count, sample);
+        for(from = filter->count; from > to; from--)
+            filter->sorted[from] = filter->sorted[from-1];
+        filter->count++;
+    }
+    else
+    {
+        from = lowerBound(filter->sorted, filter->count, filter->ring[filter->head]);
+        to = lowerBound(filter->sorted, filter->count, sample);
+        if(to > from)
+        {
+            to--;                                    // slot vacated below the insert point
+            for(; from < to; from++)
+                filter->sorted[from] = filter->sorted[from+1];
+        }
+        else
+        {
+            for(; from > to; from--)
+                filter->sorted[from] = filter->sorted[from-1];
+        }
+    }
+    filter->sorted[to] = sample;
+
+    filter->ring[filter->head] = sample;
+    filter->head++;
+    if(filter->head == filter->size)
+        filter->head = 0;
+
+    return getMedian(filter);
+}
+
+uint32_t getMedian(const MEDIAN_FILTER *filter)
+{
+    if(filter->count == 0)
+        return 0;
+    return filter->sorted[(filter->count - 1) >> 1];
+}
+
+void initHampelFilter(HAMPEL_FILTER *filter, uint8_t size, uint16_t gainQ4, uint32_t floor)
+{
+    initMedianFilter(&filter->window, size);
+    filter->gainQ4 = gainQ4;
+    filter->floor = floor;
+    filter->rejected = 0;
+}
+
+// Median absolute deviation of a sorted window, merging outward from the
+// median; O(N), (size+1)/2 steps
+static uint32_t medianDeviation(const MEDIAN_FILTER *filter, uint32_t median)
+{
+    int8_t below = (filter->count - 1) >> 1;
+    uint8_t above = below + 1;
+    uint8_t k = (filter->count - 1) >> 1;
+    uint32_t deviation = 0;
+
+    // Deviations grow in both directions, so the k-th smallest is found in k+1 steps
+    while(true)
+    {
+        if(above >= filter->count || (below >= 0 && median - filter->sorted[below] <= filter->sorted[above] - median))
+            deviation = median - filter->sorted[below--];
+        else
+            deviation = filter->sorted[above++] - median;
+        if(k-- == 0)
+            return deviation;
+    }
+}
+
+// Pass the sample through, or the window median if it is an outlier
+uint32_t hampelFilter(HAMPEL_FILTER *filter, uint32_t sample)
+{
+    uint32_t median = medianFilter(&filter->window, sample);
+    uint32_t threshold = (medianDeviation(&filter->window, median) * filter->gainQ4) >> 4;
+    uint32_t error = sample > median ? sample - median : median - sample;
+
+    if(threshold < filter->floor)
+        threshold = filter->floor;
+    if(error > threshold)
+    {
+        filter->rejected++;
+        return median;
+    }
+    return sample;
+}
+
+void initEmaFilter(EMA_FILTER *filter, uint8_t shift)
+{
+    filter->shift = shift;
+    filter->primed = false;
+}
+
+uint32_t emaFilter(EMA_FILTER *filter, uint32_t sample)
+{
+    if(!filter->primed)
+    {
+        filter->stateQ8 = sample << 8;
+        filter->primed = true;
+    }
+    else
+        filter->stateQ8 += ((int32_t)(sample << 8) - filter->stateQ8) >> filter->shift;
+
+    return (filter->stateQ8 + 128) >> 8;
+}
@@ -0,0 +1,70 @@
+// Sample Filter Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, filters are pure integer code with caller-owned state
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FILTER_MAX_WINDOW 9
+
+// Running median over the last size samples, O(N) per sample with N at
+// most FILTER_MAX_WINDOW
+typedef struct _MEDIAN_FILTER
+{
+    uint32_t ring[FILTER_MAX_WINDOW];              // samples in arrival order
+    uint32_t sorted[FILTER_MAX_WINDOW];            // same samples in ascending order
+    uint8_t size;
+    uint8_t count;
+    uint8_t head;
+} MEDIAN_FILTER;
+
+// Replaces a sample with the window median when it is more than
+// gain * MAD (median absolute deviation) away from it; O(N) per sample
+typedef struct _HAMPEL_FILTER
+{
+    MEDIAN_FILTER window;
+    uint16_t gainQ4;                               // threshold in MADs, Q4 (incl. 1.4826 sigma factor)
+    uint32_t floor;                                // smallest threshold, in sample units
+    uint32_t rejected;                             // number of samples replaced
+} HAMPEL_FILTER;
+
+// y += (x - y) / 2^shift, state kept with 8 fractional bits; O(1) per sample
+typedef struct _EMA_FILTER
+{
+    int32_t stateQ8;
+    uint8_t shift;
+    bool primed;
+} EMA_FILTER;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initMedianFilter(MEDIAN_FILTER *filter, uint8_t size);
+uint32_t medianFilter(MEDIAN_FILTER *filter, uint32_t sample);
+uint32_t getMedian(const MEDIAN_FILTER *filter);
+
+void initHampelFilter(HAMPEL_FILTER *filter, uint8_t size, uint16_t gainQ4, uint32_t floor);
+uint32_t hampelFilter(HAMPEL_FILTER *filter, uint32_t sample);
+
+void initEmaFilter(EMA_FILTER *filter, uint8_t shift);
+uint32_t emaFilter(EMA_FILTER *filter, uint32_t sample);
+
+#endif
@@ -0,0 +1,449 @@
+// IR Remote Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// IR Detector on WT3CCP0 (PD2), active low (mark = carrier present)
+// Wide Timer 3A: edge-time capture of both IR edges
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "timebase.h"
+#include "ir.h"
+
+#define IR_DETECTOR_MASK 4
+#define IR_DETECTOR (*((volatile uint32_t *)(0x42000000 + (0x400073FC-0x40000000)*32 + 2*4)))
+
+typedef enum _IR_SYMBOL
+{
+    IR_INVALID,
+    IR_LEADER,
+    IR_REPEAT,
+    IR_ZERO,
+    IR_ONE,
+    IR_SHORT,
+    IR_LONG
+} IR_SYMBOL;
+
+typedef struct _IR_WINDOW
+{
+    uint32_t min;
+    uint32_t max;
+    IR_SYMBOL symbol;
+} IR_WINDOW;
+
+// Per-decoder state, the meaning of state and code is up to each protocol
+typedef struct _IR_DECODER
+{
+    uint8_t state;
+    uint8_t bits;
+    uint32_t code;
+    uint32_t lastEdge;                             // protocol's own reference edge
+    bool held;                                     // a valid frame may still be repeating
+    uint32_t heldEdge;                             // edge of the last valid frame or repeat
+    uint32_t heldCode;
+} IR_DECODER;
+
+typedef struct _IR_PROTOCOL_DESC IR_PROTOCOL_DESC;
+
+// Feed one edge to a decoder, returns true with event filled in when a frame completes
+typedef bool (*IR_DECODE)(IR_DECODER *decoder, const IR_PROTOCOL_DESC *desc, uint32_t ticks, uint32_t width, bool mark, IR_EVENT *event);
+
+struct _IR_PROTOCOL_DESC
+{
+    IR_PROTOCOL protocol;
+    const IR_WINDOW *windows;                      // interval classes, checked in order
+    uint8_t windowCount;
+    uint8_t bits;                                  // bits per frame
+    uint32_t repeatWindow;                         // frames closer than this are a held button
+    IR_DECODE decode;
+};
+
+typedef enum _NEC_STATE
+{
+    NEC_IDLE,                                      // waiting for the first falling edge
+    NEC_START,                                     // leader mark started
+    NEC_DATA                                       // shifting in bits
+} NEC_STATE;
+
+typedef enum _RC5_STATE
+{
+    RC5_IDLE,
+    RC5_START1,                                    // bit boundary, next bit is a 1
+    RC5_MID1,                                      // middle of a 1, mark half running
+    RC5_START0,                                    // bit boundary, next bit is a 0
+    RC5_MID0                                       // middle of a 0, space half running
+} RC5_STATE;
+
+typedef enum _SIRC_STATE
+{
+    SIRC_IDLE,
+    SIRC_DATA
+} SIRC_STATE;
+
+// Edge-to-edge intervals, falling edge to falling edge
+static const IR_WINDOW necWindows[] =
+{
+    { NEC_ZERO_MIN,   NEC_ZERO_MAX,   IR_ZERO },
+    { NEC_ONE_MIN,    NEC_ONE_MAX,    IR_ONE },
+    { NEC_REPEAT_MIN, NEC_REPEAT_MAX, IR_REPEAT },
+    { NEC_LEADER_MIN, NEC_LEADER_MAX, IR_LEADER },
+};
+
+// Half and whole bit intervals between any two edges
+static const IR_WINDOW rc5Windows[] =
+{
+    { RC5_SHORT_MIN, RC5_SHORT_MAX, IR_SHORT },
+    { RC5_LONG_MIN,  RC5_LONG_MAX,  IR_LONG },
+};
+
+// Mark widths; every space is one unit and classifies as a zero
+static const IR_WINDOW sircWindows[] =
+{
+    { SIRC_ZERO_MIN,   SIRC_ZERO_MAX,   IR_ZERO },
+    { SIRC_ONE_MIN,    SIRC_ONE_MAX,    IR_ONE },
+    { SIRC_LEADER_MIN, SIRC_LEADER_MAX, IR_LEADER },
+};
+
+#define WINDOWS(w) w, sizeof(w) / sizeof(w[0])
+
+static bool necDecode(IR_DECODER *decoder, const IR_PROTOCOL_DESC *desc, uint32_t ticks, uint32_t width, bool mark, IR_EVENT *event);
+static bool rc5Decode(IR_DECODER *decoder, const IR_PROTOCOL_DESC *desc, uint32_t ticks, uint32_t width, bool mark, IR_EVENT *event);
+static bool sircDecode(IR_DECODER *decoder, const IR_PROTOCOL_DESC *desc, uint32_t ticks, uint32_t width, bool mark, IR_EVENT *event);
+
+// Candidate decoders; every edge is offered to each of them
+static const IR_PROTOCOL_DESC irProtocols[IR_PROTOCOL_COUNT] =
+{
+    { IR_NEC,  WINDOWS(necWindows),  NEC_BITS,  NEC_REPEAT_WINDOW,  necDecode },
+    { IR_RC5,  WINDOWS(rc5Windows),  RC5_BITS,  RC5_REPEAT_WINDOW,  rc5Decode },
+    { IR_SIRC, WINDOWS(sircWindows), SIRC_BITS, SIRC_REPEAT_WINDOW, sircDecode },
+};
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static IR_DECODER irDecoders[IR_PROTOCOL_COUNT];
+static uint32_t lastEdge = 0;
+static uint32_t irRejected = 0;
+
+// Single-producer (edge ISR) / single-consumer (main loop) ring of decoded frames;
+// each index is only written by its owner, so no locking is needed
+static volatile IR_EVENT irQueue[IR_QUEUE_SIZE];
+static volatile uint8_t irHead = 0;
+static volatile uint8_t irTail = 0;
+static volatile uint32_t irDropped = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Initialize edge-time capture of the IR detector; the timer latches each
+// edge, so the decode no longer shares the right collector's vector
+void initIr()
+{
+    SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R3;
+    SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R3;
+    _delay_cycles(3);
+
+    GPIO_PORTD_DIR_R &= ~IR_DETECTOR_MASK;
+    GPIO_PORTD_DEN_R |= IR_DETECTOR_MASK;
+    GPIO_PORTD_AFSEL_R |= IR_DETECTOR_MASK;
+    GPIO_PORTD_PCTL_R &= ~GPIO_PCTL_PD2_M;
+    GPIO_PORTD_PCTL_R |= GPIO_PCTL_PD2_WT3CCP0;
+
+    WTIMER3_CTL_R &= ~TIMER_CTL_TAEN;                // turn-off timer before reconfiguring
+    WTIMER3_CFG_R = 4;                               // configure as 32-bit timer (A only)
+    WTIMER3_TAMR_R = TIMER_TAMR_TAMR_CAP | TIMER_TAMR_TACMR | TIMER_TAMR_TACDIR; // edge-time mode, count up
+    WTIMER3_CTL_R = TIMER_CTL_TAEVENT_BOTH;          // capture both edges, RC5 and SIRC need mark widths
+    WTIMER3_TAILR_R = 0xFFFFFFFF;                    // wrap at 32 bits so intervals subtract cleanly
+    WTIMER3_ICR_R = TIMER_ICR_CAECINT;
+    WTIMER3_IMR_R = TIMER_IMR_CAEIM;
+    NVIC_PRI25_R = (NVIC_PRI25_R & ~0xE0) | (2 << 5);  // interrupt 116 at priority 2, below the encoder edges
+    NVIC_EN3_R = 1 << (INT_WTIMER3A-16-96);          // turn-on interrupt 116 (WTIMER3A)
+    WTIMER3_CTL_R |= TIMER_CTL_TAEN;                 // turn-on timer
+}
+
+static IR_SYMBOL classify(const IR_PROTOCOL_DESC *desc, uint32_t interval)
+{
+    uint8_t i;
+
+    for(i = 0; i < desc->windowCount; i++)
+        if(interval >= desc->windows[i].min && interval <= desc->windows[i].max)
+            return desc->windows[i].symbol;
+    return IR_INVALID;
+}
+
+// Record a completed frame, returns true if it continues a held button
+static bool irHeld(IR_DECODER *decoder, const IR_PROTOCOL_DESC *desc, uint32_t ticks, uint32_t code)
+{
+    bool repeat = decoder->held && decoder->heldCode == code && ticks - decoder->heldEdge <= desc->repeatWindow;
+
+    decoder->held = true;
+    decoder->heldEdge = ticks;
+    decoder->heldCode = code;
+    return repeat;
+}
+
+// NEC: pulse distance, timed falling edge to falling edge; each bit is
+// shifted straight into the code word and frames whose inverted bytes do
+// not match are rejected
+static bool necDecode(IR_DECODER *decoder, const IR_PROTOCOL_DESC *desc, uint32_t ticks, uint32_t width, bool mark, IR_EVENT *event)
+{
+    IR_SYMBOL symbol;
+
+    (void)width;                                     // NEC times edge to edge, not mark widths
+    if(mark)
+        return false;
+    symbol = classify(desc, ticks - decoder->lastEdge);
+    decoder->lastEdge = ticks;
+
+    switch(decoder->state)
+    {
+    case NEC_IDLE:
+        decoder->state = NEC_START;
+        break;
+    case NEC_START:
+        if(symbol == IR_LEADER)
+        {
+            decoder->code = 0;
+            decoder->bits = 0;
+            decoder->state = NEC_DATA;
+        }
+        else if(symbol == IR_REPEAT && decoder->held && ticks - decoder->heldEdge <= desc->repeatWindow)
+        {
+            decoder->heldEdge = ticks;
+            decoder->state = NEC_IDLE;
+            event->address = decoder->heldCode;
+            event->command = decoder->heldCode >> 16;
+            event->repeat = true;
+            return true;
+        }
+        break;                                       // anything else restarts the leader here
+    case NEC_DATA:
+        if(symbol == IR_ZERO || symbol == IR_ONE)
+        {
+            decoder->code = (decoder->code >> 1) | ((uint32_t)(symbol == IR_ONE) << 31);  // LSB first
+            if(++decoder->bits == desc->bits)
+            {
+                decoder->state = NEC_IDLE;
+                decoder->held = false;
+                if((uint8_t)(decoder->code ^ (decoder->code >> 8)) != 0xFF || (uint8_t)((decoder->code >> 16) ^ (decoder->code >> 24)) != 0xFF)
+                {
+                    irRejected++;
+                    return false;
+                }
+                irHeld(decoder, desc, ticks, decoder->code);
+                event->address = decoder->code;
+                event->command = decoder->code >> 16;
+                event->repeat = false;                 // NEC signals a held button with repeat frames
+                return true;
+            }
+        }
+        else
+            decoder->state = NEC_START;              // this edge may begin a new frame
+        break;
+    }
+    return false;
+}
+
+// RC5: Manchester, MSB first (S1 S2 toggle A4..A0 C5..C0); a 1 is a space
+// then a mark, so every bit is emitted on its mid-bit edge
+static bool rc5Decode(IR_DECODER *decoder, const IR_PROTOCOL_DESC *desc, uint32_t ticks, uint32_t width, bool mark, IR_EVENT *event)
+{
+    IR_SYMBOL symbol = classify(desc, width);
+    int8_t bit = -1;
+
+    switch(decoder->state)
+    {
+    case RC5_MID1:
+        if(mark && symbol == IR_SHORT)
+            decoder->state = RC5_START1;
+        else if(mark && symbol == IR_LONG)
+        {
+            decoder->state = RC5_MID0;
+            bit = 0;
+        }
+        else
+            decoder->state = RC5_IDLE;
+        break;
+    case RC5_MID0:
+        if(!mark && symbol == IR_SHORT)
+            decoder->state = RC5_START0;
+        else if(!mark && symbol == IR_LONG)
+        {
+            decoder->state = RC5_MID1;
+            bit = 1;
+        }
+        else
+            decoder->state = RC5_IDLE;
+        break;
+    case RC5_START1:
+        if(!mark && symbol == IR_SHORT)
+        {
+            decoder->state = RC5_MID1;
+            bit = 1;
+        }
+        else
+            decoder->state = RC5_IDLE;
+        break;
+    case RC5_START0:
+        if(mark && symbol == IR_SHORT)
+        {
+            decoder->state = RC5_MID0;
+            bit = 0;
+        }
+        else
+            decoder->state = RC5_IDLE;
+        break;
+    default:
+        break;
+    }
+
+    if(decoder->state == RC5_IDLE)
+    {
+        if(!mark)                                    // mark starting mid-way through S1
+        {
+            decoder->code = 1;
+            decoder->bits = 1;
+            decoder->state = RC5_MID1;
+        }
+        return false;
+    }
+    if(bit < 0)
+        return false;
+
+    decoder->code = (decoder->code << 1) | bit;
+    if(++decoder->bits < desc->bits)
+        return false;
+
+    decoder->state = RC5_IDLE;
+    event->repeat = irHeld(decoder, desc, ticks, decoder->code);  // same toggle bit while held
+    event->address = (decoder->code >> 6) & 0x1F;
+    event->command = (decoder->code & 0x3F) | ((decoder->code & 0x1000) ? 0 : 0x40);  // RC5X uses ~S2 as bit 6
+    return true;
+}
+
+// Sony SIRC (12 bit): pulse width, LSB first (7 command then 5 address bits);
+// bits are the mark widths and every space must be one unit
+static bool sircDecode(IR_DECODER *decoder, const IR_PROTOCOL_DESC *desc, uint32_t ticks, uint32_t width, bool mark, IR_EVENT *event)
+{
+    IR_SYMBOL symbol = classify(desc, width);
+
+    if(mark && symbol == IR_LEADER)
+    {
+        decoder->code = 0;
+        decoder->bits = 0;
+        decoder->state = SIRC_DATA;
+        return false;
+    }
+    if(decoder->state != SIRC_DATA)
+        return false;
+    if(!mark)
+    {
+        if(symbol != IR_ZERO)
+            decoder->state = SIRC_IDLE;
+        return false;
+    }
+    if(symbol != IR_ZERO && symbol != IR_ONE)
+    {
+        decoder->state = SIRC_IDLE;
+        return false;
+    }
+
+    decoder->code |= (uint32_t)(symbol == IR_ONE) << decoder->bits;
+    if(++decoder->bits < desc->bits)
+        return false;
+
+    decoder->state = SIRC_IDLE;
+    event->repeat = irHeld(decoder, desc, ticks, decoder->code);  // frames repeat while held
+    event->address = decoder->code >> 7;
+    event->command = decoder->code & 0x7F;
+    return true;
+}
+
+static void pushIrEvent(const IR_EVENT *event)
+{
+    uint8_t head = irHead;
+
+    if((uint8_t)(head - irTail) >= IR_QUEUE_SIZE)
+    {
+        irDropped++;
+        return;
+    }
+    irQueue[head & (IR_QUEUE_SIZE-1)].protocol = event->protocol;
+    irQueue[head & (IR_QUEUE_SIZE-1)].address = event->address;
+    irQueue[head & (IR_QUEUE_SIZE-1)].command = event->command;
+    irQueue[head & (IR_QUEUE_SIZE-1)].repeat = event->repeat;
+    irQueue[head & (IR_QUEUE_SIZE-1)].time = getTicks();
+    irHead = head + 1;                               // publish after the slot is written
+}
+
+// Take the oldest decoded frame, returns false if none are waiting
+bool getIrEvent(IR_EVENT *event)
+{
+    uint8_t tail = irTail;
+
+    if(tail == irHead)
+        return false;
+    event->protocol = irQueue[tail & (IR_QUEUE_SIZE-1)].protocol;
+    event->address = irQueue[tail & (IR_QUEUE_SIZE-1)].address;
+    event->command = irQueue[tail & (IR_QUEUE_SIZE-1)].command;
+    event->repeat = irQueue[tail & (IR_QUEUE_SIZE-1)].repeat;
+    event->time = irQueue[tail & (IR_QUEUE_SIZE-1)].time;
+    irTail = tail + 1;                               // release the slot after reading
+    return true;
+}
+
+uint32_t getIrDropped()
+{
+    return irDropped;
+}
+
+uint32_t getIrRejected()
+{
+    return irRejected;
+}
+
+// Feed one edge timestamp to every decoder, returns true when a frame or
+// repeat has been queued; each decoder is a constant-time state machine
+bool irEdge(uint32_t ticks, bool mark)
+{
+    uint32_t width = ticks - lastEdge;
+    IR_EVENT event;
+    bool queued = false;
+    uint8_t i;
+
+    lastEdge = ticks;
+    for(i = 0; i < IR_PROTOCOL_COUNT; i++)
+    {
+        if(irProtocols[i].decode(&irDecoders[i], &irProtocols[i], ticks, width, mark, &event))
+        {
+            event.protocol = irProtocols[i].protocol;
+            pushIrEvent(&event);
+            queued = true;
+        }
+    }
+    return queued;
+}
+
+// Edge latched by the capture timer; the timestamp is exact even if this
+// interrupt is held off by the encoder edges, and the pin has settled to
+// the new level by the time it runs (edges are at least 560 us apart)
+void IrCaptureIsr()
+{
+    WTIMER3_ICR_R = TIMER_ICR_CAECINT;
+    irEdge(WTIMER3_TAR_R, IR_DETECTOR != 0);         // detector high again, a mark just ended
+}
@@ -0,0 +1,95 @@
+// IR Remote Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// IR Detector on WT3CCP0 (PD2), active low (mark = carrier present)
+// Wide Timer 3A: edge-time capture of both IR edges
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef IR_H_
+#define IR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// NEC timing in 40 MHz ticks, measured falling edge to falling edge
+#define NEC_UNIT_TICKS 22500                       // 562.5 us
+#define NEC_LEADER_MIN (13 * 40000)                // 9 ms mark + 4.5 ms space
+#define NEC_LEADER_MAX (14 * 40000)
+#define NEC_REPEAT_MIN (43 * 40000 / 4)            // 9 ms mark + 2.25 ms space
+#define NEC_REPEAT_MAX (47 * 40000 / 4)
+#define NEC_REPEAT_PERIOD_MS 108                   // repeats follow a frame every 108 ms
+#define NEC_REPEAT_WINDOW (130 * 40000)
+#define NEC_ZERO_MIN (3 * NEC_UNIT_TICKS / 2)      // 2 units
+#define NEC_ZERO_MAX (5 * NEC_UNIT_TICKS / 2)
+#define NEC_ONE_MIN (7 * NEC_UNIT_TICKS / 2)       // 4 units
+#define NEC_ONE_MAX (9 * NEC_UNIT_TICKS / 2)
+#define NEC_BITS 32
+
+// RC5 timing in 40 MHz ticks, any edge to the next (Manchester half bits)
+#define RC5_UNIT_TICKS 35556                       // 889 us half bit
+#define RC5_SHORT_MIN (3 * RC5_UNIT_TICKS / 4)     // 1 half bit
+#define RC5_SHORT_MAX (5 * RC5_UNIT_TICKS / 4)
+#define RC5_LONG_MIN (3 * RC5_UNIT_TICKS / 2)      // 2 half bits
+#define RC5_LONG_MAX (5 * RC5_UNIT_TICKS / 2)
+#define RC5_REPEAT_PERIOD_MS 114                   // frames follow every 114 ms, same toggle bit
+#define RC5_REPEAT_WINDOW (150 * 40000)
+#define RC5_BITS 14
+
+// Sony SIRC timing in 40 MHz ticks, mark widths (spaces are all one unit)
+#define SIRC_UNIT_TICKS 24000                      // 600 us
+#define SIRC_ZERO_MIN (3 * SIRC_UNIT_TICKS / 4)    // 1 unit (also the space width)
+#define SIRC_ZERO_MAX (3 * SIRC_UNIT_TICKS / 2)
+#define SIRC_ONE_MIN (7 * SIRC_UNIT_TICKS / 4)     // 2 units
+#define SIRC_ONE_MAX (5 * SIRC_UNIT_TICKS / 2)
+#define SIRC_LEADER_MIN (7 * SIRC_UNIT_TICKS / 2)  // 4 units
+#define SIRC_LEADER_MAX (9 * SIRC_UNIT_TICKS / 2)
+#define SIRC_REPEAT_PERIOD_MS 45                   // frames follow every 45 ms
+#define SIRC_REPEAT_WINDOW (70 * 40000)
+#define SIRC_BITS 12
+
+#define IR_QUEUE_SIZE 8                            // power of two
+
+typedef enum _IR_PROTOCOL
+{
+    IR_NEC,
+    IR_RC5,
+    IR_SIRC,
+    IR_PROTOCOL_COUNT
+} IR_PROTOCOL;
+
+typedef struct _IR_EVENT
+{
+    IR_PROTOCOL protocol;
+    uint8_t address;
+    uint8_t command;
+    bool repeat;                                   // button still held, same address and command
+    uint32_t time;                                 // timebase ticks at the end of the frame
+} IR_EVENT;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initIr();
+bool getIrEvent(IR_EVENT *event);
+uint32_t getIrDropped();
+uint32_t getIrRejected();
+
+// Hardware independent decoders, driven by the capture ISR (or recorded
+// pulse trains on a host); mark is true when the interval ending at this
+// edge had carrier present
+bool irEdge(uint32_t ticks, bool mark);
+
+#endif
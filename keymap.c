@@ -0,0 +1,175 @@
+// Remote Keymap Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Bindings kept in on-chip EEPROM
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include "eeprom.h"
+#include "uart0.h"
+#include "keymap.h"
+
+// EEPROM layout: magic word, then one word per entry
+#define KEYMAP_WORDS KEYMAP_SIZE
+
+static const char *actionNames[ACTION_COUNT] =
+{
+    "none", "forward", "reverse", "ccw", "cw", "stop", "navigate", "wallping"
+};
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+// Direct-indexed by command byte, loaded once at boot
+static KEYMAP_ENTRY keymap[KEYMAP_SIZE];
+static bool eepromOk = false;                      // bindings are kept in RAM only if false
+static bool learning = false;
+static REMOTE_ACTION learnAction = ACTION_NONE;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void saveKeymapWord(uint8_t word)
+{
+    uint32_t data;
+
+    if(!eepromOk)
+        return;
+    memcpy(&data, &keymap[word], 4);
+    if(readEeprom(EEPROM_KEYMAP + 1 + word) != data)
+        writeEeprom(EEPROM_KEYMAP + 1 + word, data);
+}
+
+// Default binding, any NEC address as the firmware accepted before learning
+static void bindDefault(uint8_t command, REMOTE_ACTION action)
+{
+    keymap[command].action = action;
+    keymap[command].protocol = IR_NEC;
+    keymap[command].address = 0;
+    keymap[command].flags = KEYMAP_ANY_ADDRESS;
+}
+
+// Bindings for the LG remote the robot shipped with
+void resetKeymap()
+{
+    uint16_t i;
+
+    memset(keymap, 0, sizeof(keymap));
+    bindDefault(64, ACTION_FORWARD);
+    bindDefault(65, ACTION_REVERSE);
+    bindDefault(7, ACTION_CCW);
+    bindDefault(6, ACTION_CW);
+    bindDefault(68, ACTION_STOP);
+    bindDefault(16, ACTION_NAVIGATE);
+    bindDefault(26, ACTION_WALLPING);
+    if(!eepromOk)
+        return;
+    for(i = 0; i < KEYMAP_WORDS; i++)
+        saveKeymapWord(i);
+    writeEeprom(EEPROM_KEYMAP, KEYMAP_MAGIC);
+}
+
+// Load the table from EEPROM, writing the defaults on first boot
+void initKeymap()
+{
+    uint32_t data;
+    uint16_t i;
+
+    eepromOk = initEeprom();
+    if(!eepromOk || readEeprom(EEPROM_KEYMAP) != KEYMAP_MAGIC)
+    {
+        resetKeymap();
+        return;
+    }
+    for(i = 0; i < KEYMAP_WORDS; i++)
+    {
+        data = readEeprom(EEPROM_KEYMAP + 1 + i);
+        memcpy(&keymap[i], &data, 4);
+        if(keymap[i].action >= ACTION_COUNT || keymap[i].protocol >= IR_PROTOCOL_COUNT)
+            keymap[i].action = ACTION_NONE;
+    }
+}
+
+// Single lookup by command byte; the entry only fires for the remote it was
+// bound to, so another remote sending the same byte is ignored
+REMOTE_ACTION getRemoteAction(const IR_EVENT *event)
+{
+    const KEYMAP_ENTRY *entry = &keymap[event->command];
+
+    if(entry->protocol != event->protocol
+       || (!(entry->flags & KEYMAP_ANY_ADDRESS) && entry->address != event->address))
+        return ACTION_NONE;
+    return (REMOTE_ACTION)entry->action;
+}
+
+// Bind a frame's command byte, for its protocol and address only, and persist it
+void setRemoteAction(const IR_EVENT *event, REMOTE_ACTION action)
+{
+    KEYMAP_ENTRY *entry = &keymap[event->command];
+
+    entry->action = action;
+    entry->protocol = event->protocol;
+    entry->address = event->address;
+    entry->flags = 0;
+    saveKeymapWord(event->command);
+}
+
+void getKeymapEntry(uint8_t command, KEYMAP_ENTRY *entry)
+{
+    *entry = keymap[command];
+}
+
+const char* getActionName(REMOTE_ACTION action)
+{
+    return action < ACTION_COUNT ? actionNames[action] : "?";
+}
+
+// Arm learning for an action by name, the next new frame is bound to it
+bool startLearning(const char name[])
+{
+    uint8_t i;
+
+    for(i = 0; i < ACTION_COUNT; i++)
+    {
+        if(strcmp(name, actionNames[i]) == 0)
+        {
+            learnAction = (REMOTE_ACTION)i;
+            learning = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Offer a decoded frame to learning mode, returns true if it was consumed
+bool learnRemote(const IR_EVENT *event)
+{
+    char str[48];
+
+    if(!learning)
+        return false;
+    if(event->repeat)
+        return true;                                 // still the same press
+    learning = false;
+    setRemoteAction(event, learnAction);
+    snprintf(str, sizeof(str), "Learned %u/%u/%u as %s\n", event->protocol, event->address, event->command, getActionName(learnAction));
+    putsUart0(str);
+    return true;
+}
@@ -0,0 +1,65 @@
+// Remote Keymap Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Bindings kept in on-chip EEPROM
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef KEYMAP_H_
+#define KEYMAP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ir.h"
+
+#define KEYMAP_SIZE 256                            // one entry per command byte
+#define KEYMAP_MAGIC 0x4B4D0002                    // "KM", layout version 2
+#define KEYMAP_ANY_ADDRESS 1                       // entry flag: match every address of the protocol
+
+typedef enum _REMOTE_ACTION
+{
+    ACTION_NONE,
+    ACTION_FORWARD,
+    ACTION_REVERSE,
+    ACTION_CCW,
+    ACTION_CW,
+    ACTION_STOP,
+    ACTION_NAVIGATE,
+    ACTION_WALLPING,
+    ACTION_COUNT
+} REMOTE_ACTION;
+
+// One word per command byte: the action and the remote it was learned from
+typedef struct _KEYMAP_ENTRY
+{
+    uint8_t action;                                // REMOTE_ACTION
+    uint8_t protocol;                              // IR_PROTOCOL
+    uint8_t address;
+    uint8_t flags;
+} KEYMAP_ENTRY;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initKeymap();
+REMOTE_ACTION getRemoteAction(const IR_EVENT *event);
+void setRemoteAction(const IR_EVENT *event, REMOTE_ACTION action);
+void getKeymapEntry(uint8_t command, KEYMAP_ENTRY *entry);
+void resetKeymap();
+bool startLearning(const char name[]);
+bool learnRemote(const IR_EVENT *event);
+const char* getActionName(REMOTE_ACTION action);
+
+#endif
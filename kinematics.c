@@ -0,0 +1,101 @@
+// Kinematics Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, converts moves to encoder tick targets
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "kinematics.h"
+
+// pi as 355/113, good to 0.1 ppm
+#define PI_NUM 355
+#define PI_DEN 113
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static KINEMATICS kin;
+static int32_t lineCarryQ8 = 0;                    // travel asked for but not yet ticked, um (Q8), forward positive
+static int32_t turnCarryQ8 = 0;                    // ccw positive
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initKinematics()
+{
+    setKinematics(KIN_WHEEL_DIAMETER_UM, KIN_TRACK_UM, KIN_TICKS_PER_REV);
+}
+
+// Calibrate the model; the per-tick travel is worked out once here so the
+// conversions below are a multiply and a divide
+void setKinematics(uint32_t wheelDiameterUm, uint32_t trackUm, uint32_t ticksPerRev)
+{
+    kin.wheelDiameterUm = wheelDiameterUm;
+    kin.trackUm = trackUm;
+    kin.ticksPerRev = ticksPerRev;
+    kin.umPerTickQ8 = ((uint64_t)wheelDiameterUm * PI_NUM * 256 + (uint64_t)PI_DEN * ticksPerRev / 2)
+                      / ((uint64_t)PI_DEN * ticksPerRev);
+    clearKinematicsCarry();
+}
+
+// Forget the rounding carried between moves, for when a move is cut short
+// and the ticks it was given were never all driven
+void clearKinematicsCarry()
+{
+    lineCarryQ8 = 0;
+    turnCarryQ8 = 0;
+}
+
+void getKinematics(KINEMATICS *kinematics)
+{
+    *kinematics = kin;
+}
+
+// Round a signed travel to whole ticks, keeping what was left over for next
+// time. The carry is signed too, so a move and its reverse net to zero ticks.
+// Rounding is half away from zero and the carry is at most half a tick, so
+// the ticks never run against the travel asked for.
+static uint32_t travelToTicks(int64_t travelQ8, int32_t *carryQ8)
+{
+    int64_t total = travelQ8 + *carryQ8;
+    int32_t ticks;
+
+    if(total < 0)
+        ticks = -((-total + kin.umPerTickQ8 / 2) / kin.umPerTickQ8);
+    else
+        ticks = (total + kin.umPerTickQ8 / 2) / kin.umPerTickQ8;
+    *carryQ8 = total - (int64_t)ticks * kin.umPerTickQ8;
+    return ticks < 0 ? -ticks : ticks;
+}
+
+// Ticks per wheel for a straight move, forward positive
+uint32_t distanceToTicks(int32_t mm)
+{
+    return travelToTicks((int64_t)mm * 1000 * 256, &lineCarryQ8);
+}
+
+// Ticks per wheel for a pivot, ccw positive; each wheel runs
+// pi * track * degrees / 360
+uint32_t angleToTicks(int32_t degrees)
+{
+    return travelToTicks((int64_t)degrees * kin.trackUm * PI_NUM * 256 / (360 * PI_DEN), &turnCarryQ8);
+}
+
+uint32_t ticksToUm(uint32_t ticks)
+{
+    return ((uint64_t)ticks * kin.umPerTickQ8 + 128) >> 8;
+}
@@ -0,0 +1,52 @@
+// Kinematics Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, converts moves to encoder tick targets
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef KINEMATICS_H_
+#define KINEMATICS_H_
+
+#include <stdint.h>
+#include "encoder.h"
+
+// Default calibration, 245 mm per wheel turn and 6 ticks per 73 degrees of pivot
+#define KIN_WHEEL_DIAMETER_UM 78000
+#define KIN_TRACK_UM 115400                        // wheel centre to wheel centre
+#define KIN_TICKS_PER_REV ENCODER_EDGES_PER_REV
+
+#define NO_LIMIT 0xFFFFFFFF                        // tick target for moves that run until stopped
+
+typedef struct _KINEMATICS
+{
+    uint32_t wheelDiameterUm;
+    uint32_t trackUm;
+    uint32_t ticksPerRev;
+    uint32_t umPerTickQ8;                          // derived, wheel travel per tick
+} KINEMATICS;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initKinematics();
+void setKinematics(uint32_t wheelDiameterUm, uint32_t trackUm, uint32_t ticksPerRev);
+void clearKinematicsCarry();
+void getKinematics(KINEMATICS *kinematics);
+uint32_t distanceToTicks(int32_t mm);
+uint32_t angleToTicks(int32_t degrees);
+uint32_t ticksToUm(uint32_t ticks);
+
+#endif
@@ -9,41 +9,58 @@
 #include "uart0.h"
 #include "navigate.h"
 #include "linked_list.h"
-int d = 0;
-int valid = 0;
+#include "ultrasonic.h"
+#include "timebase.h"
+#include "ir.h"
+#include "keymap.h"
+#include "control.h"
+#include "kinematics.h"
+#include "odometry.h"
+#include "encoder.h"
+#include "calibration.h"
 
 
 int main(void)
 {
     initHw();
+    initTimebase();
+    initKinematics();
+    initOdometry();
     initMovement();
+    initEncoders();
+    initControl();
+    initRanging();
+    initIr();
+    initKeymap();
+    initCalibration();
     initUart0();
     setUart0BaudRate(19200, 40e6);
+    startRangingService(RANGE_SERVICE_HZ);
     USER_DATA data;
+    IR_EVENT event;
     while (true)
     {
 
         if(kbhitUart0())
             uartcmd(&data);
-        if(DATA == 16)
+        while(getIrEvent(&event))
         {
-            valid = 1;
-        }
-        if(valid)
-        {
-            navigate();
-            valid = 0;
-        }
-        if(DATA == 26)
-        {
-            wallpingtest();
+            if(learnRemote(&event))
+                continue;
+            if(event.repeat)
+                remoteRepeat(&event);
+            else
+            {
+                DATA = getRemoteAction(&event);
+                remote(&event);
+                DATA = ACTION_NONE;                  // each press dispatches once
+            }
         }
-
-        d = measure_mm();
-        waitMicrosecond(10000);
+        remoteCheck();
+        updateNavigate();
 
         motion_sense();
-        waitMicrosecond(100000);
+        waitMicrosecond(10000);
     }
 
 }
@@ -0,0 +1,122 @@
+// Motor Output Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Right Motor 1 on M0PWM6 (PC4), M0PWM3a, reverse
+// Right Motor 2 on M0PWM7 (PC5), M0PWM3b, forward
+// Left Motor 1 on M1PWM0 (PD0), M1PWM0a, forward
+// Left Motor 2 on M1PWM1 (PD1), M1PWM0b, reverse
+// Compare values are globally synchronised, staged writes take effect together
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "encoder.h"
+#include "motor.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Configure both generators, the pins must already be routed to the PWM modules
+void initMotors()
+{
+    SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R1;
+    SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R0;
+    _delay_cycles(3);
+
+    SYSCTL_SRPWM_R = SYSCTL_SRPWM_R1;                // reset PWM1 module
+    SYSCTL_SRPWM_R = SYSCTL_SRPWM_R0;                // reset PWM0 module
+    SYSCTL_SRPWM_R = 0;                              // leave reset state
+    PWM0_3_CTL_R = 0;                                // turn-off PWM0 generator 3 (drives outs 6 and 7)
+    PWM1_0_CTL_R = 0;                                // turn-off PWM1 generator 0 (drives outs 1 and 2)
+    PWM0_3_GENA_R = PWM_0_GENA_ACTCMPAD_ONE | PWM_0_GENA_ACTLOAD_ZERO;
+                                                     // output 6 on PWM0, gen 3a, cmpa
+    PWM0_3_GENB_R = PWM_0_GENB_ACTCMPBD_ONE | PWM_0_GENB_ACTLOAD_ZERO;
+                                                     // output 7 on PWM0, gen 3b, cmpb
+    PWM1_0_GENA_R = PWM_1_GENA_ACTCMPAD_ONE | PWM_1_GENA_ACTLOAD_ZERO;
+                                                     // output 0 on PWM1, gen 0a, cmpa
+    PWM1_0_GENB_R = PWM_1_GENB_ACTCMPBD_ONE | PWM_1_GENB_ACTLOAD_ZERO;
+                                                     // output 1 on PWM1, gen 0b, cmpb
+    PWM0_3_LOAD_R = MOTOR_PWM_LOAD;
+    PWM1_0_LOAD_R = MOTOR_PWM_LOAD;
+    PWM0_3_CMPA_R = 0;                               // both motors off
+    PWM0_3_CMPB_R = 0;
+    PWM1_0_CMPA_R = 0;
+    PWM1_0_CMPB_R = 0;
+
+    // Compare writes are held until a global sync, then loaded at the next
+    // counter zero; the generators are started back to back so their
+    // counters stay within a few clocks of each other
+    PWM0_3_CTL_R = PWM_0_CTL_CMPAUPD | PWM_0_CTL_CMPBUPD | PWM_0_CTL_ENABLE;
+    PWM1_0_CTL_R = PWM_1_CTL_CMPAUPD | PWM_1_CTL_CMPBUPD | PWM_1_CTL_ENABLE;
+    PWM0_ENABLE_R = PWM_ENABLE_PWM6EN | PWM_ENABLE_PWM7EN;
+    PWM1_ENABLE_R = PWM_ENABLE_PWM0EN | PWM_ENABLE_PWM1EN;
+}
+
+// Buffer the drive of one wheel (positive is forward) until commitMotors()
+void stageMotor(uint8_t wheel, int32_t pwm)
+{
+    if(pwm > MOTOR_PWM_MAX)
+        pwm = MOTOR_PWM_MAX;
+    if(pwm < -MOTOR_PWM_MAX)
+        pwm = -MOTOR_PWM_MAX;
+    if(wheel == ENCODER_LEFT)
+    {
+        PWM1_0_CMPA_R = pwm > 0 ? pwm : 0;
+        PWM1_0_CMPB_R = pwm < 0 ? -pwm : 0;
+    }
+    else
+    {
+        PWM0_3_CMPB_R = pwm > 0 ? pwm : 0;
+        PWM0_3_CMPA_R = pwm < 0 ? -pwm : 0;
+    }
+}
+
+// Buffer a short brake: both bridge inputs held high so the motor windings
+// are shorted through the low-side switches
+void stageMotorBrake(uint8_t wheel)
+{
+    if(wheel == ENCODER_LEFT)
+    {
+        PWM1_0_CMPA_R = MOTOR_PWM_MAX;
+        PWM1_0_CMPB_R = MOTOR_PWM_MAX;
+    }
+    else
+    {
+        PWM0_3_CMPA_R = MOTOR_PWM_MAX;
+        PWM0_3_CMPB_R = MOTOR_PWM_MAX;
+    }
+}
+
+// Release everything staged on both modules. The sync requests are issued
+// clear of a counter reload, so the four compares land on the same period.
+// Callers that can be preempted by another writer (the encoder edge ISRs
+// stop the motors) mask interrupts from the first stage to the commit.
+void commitMotors()
+{
+    while(PWM0_3_COUNT_R < MOTOR_SYNC_GUARD || PWM1_0_COUNT_R < MOTOR_SYNC_GUARD);
+    PWM0_CTL_R = PWM_CTL_GLOBALSYNC3;
+    PWM1_CTL_R = PWM_CTL_GLOBALSYNC0;
+}
+
+void setMotors(int32_t left, int32_t right)
+{
+    __asm(" CPSID I");
+    stageMotor(ENCODER_LEFT, left);
+    stageMotor(ENCODER_RIGHT, right);
+    commitMotors();
+    __asm(" CPSIE I");
+}
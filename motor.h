@@ -0,0 +1,43 @@
+// Motor Output Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Right Motor 1 on M0PWM6 (PC4), M0PWM3a, reverse
+// Right Motor 2 on M0PWM7 (PC5), M0PWM3b, forward
+// Left Motor 1 on M1PWM0 (PD0), M1PWM0a, forward
+// Left Motor 2 on M1PWM1 (PD1), M1PWM0b, reverse
+// Compare values are globally synchronised, staged writes take effect together
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef MOTOR_H_
+#define MOTOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MOTOR_PWM_LOAD 1024
+#define MOTOR_PWM_MAX 1023
+#define MOTOR_SYNC_GUARD 32                        // PWM clocks kept clear of the counter reload on commit
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initMotors();
+void stageMotor(uint8_t wheel, int32_t pwm);
+void stageMotorBrake(uint8_t wheel);
+void commitMotors();
+void setMotors(int32_t left, int32_t right);
+
+#endif
@@ -35,10 +35,19 @@
 #include "movement.h"
 #include "uart0.h"
 #include "navigate.h"
+#include "ultrasonic.h"
+#include "approach.h"
+#include "timebase.h"
+#include "keymap.h"
+#include "encoder.h"
+#include "control.h"
+#include "profile.h"
+#include "kinematics.h"
+#include "odometry.h"
+#include "segment.h"
+#include "motor.h"
+#include "filter.h"
 
-//PortB masks
-#define ECHO_MASK 4
-#define TRIG_MASK 64
 // PortC masks
 #define RIGHT_MOTOR1 16
 #define RIGHT_MOTOR2 32
@@ -47,13 +56,10 @@
 #define LEFT_MOTOR1 1
 #define LEFT_MOTOR2 2
 #define RIGHT_COLLECTOR 64
-#define IR_DETECTOR 4
 // PortE masks
 #define SLEEP_MASK 2
 #define PIR_MASK 8
 // BitBand Aliases
-#define ECHO_PIN (*((volatile uint32_t *)(0x42000000 + (0x400053FC-0x40000000)*32 + 2*4)))
-#define TRIG_PIN (*((volatile uint32_t *)(0x42000000 + (0x400053FC-0x40000000)*32 + 6*4)))
 #define SLEEP_BUTTON (*((volatile uint32_t *)(0x42000000 + (0x400243FC-0x40000000)*32 + 1*4)))
 #define PIR_SENSOR (*((volatile uint32_t *)(0x42000000 + (0x400243FC-0x40000000)*32 + 3*4)))
 #define RED_LED      (*((volatile uint32_t *)(0x42000000 + (0x400253FC-0x40000000)*32 + 1*4)))
@@ -68,21 +74,34 @@
 // Global variables
 //-----------------------------------------------------------------------------
 #define INPUT_PIN_0_MASK 1
-#define T 22500.0
-#define TICKS_PER_MS 40000
 
-uint32_t time[50] = { 0 };
-uint8_t count;
-uint8_t code = 0;
-uint8_t ADDR;
-uint8_t ADDRNOT;
+#define REMOTE_HOLD_SLACK_MS 4                     // drive stops this long after a repeat frame is due
+#define NAVIGATE_SAMPLES 3                         // fresh pings, median taken, per heading
+#define NAVIGATE_PAUSE_MS 3000                     // hold still this long when the PIR sees someone
 
-uint8_t DATANOT;
-uint32_t newcode = 0;
 char string[8] = { '0' };
 int buffer;
-float limit;
-bool targetreached = false;
+volatile uint32_t limit = NO_LIMIT;                // tick target of the current move
+volatile bool targetreached = false;
+#if !ENCODER_SOFTWARE_COUNT
+static uint32_t moveBase[ENCODER_COUNT];           // encoder counts at the start of the move
+#endif
+static volatile bool moveActive = false;           // a tick target is armed
+
+typedef enum _STOP_PHASE
+{
+    STOP_IDLE,
+    STOP_PULSE,
+    STOP_HOLD
+} STOP_PHASE;
+
+static volatile STOP_PHASE stopPhase = STOP_IDLE;
+static STOP_MODE stopMode = STOP_BRAKE;
+static uint32_t stopHoldTicks = STOP_HOLD_MS * CONTROL_HZ / 1000;
+static uint32_t stopTimer;                         // control ticks into the current phase
+static uint32_t stopLimit;                         // tick target the stop was started for
+static int8_t pulseDir[ENCODER_COUNT];             // reverse pulse still running per wheel
+static int32_t overshoot[ENCODER_COUNT];           // ticks past the target once stopped
 
 
 //-----------------------------------------------------------------------------
@@ -93,10 +112,6 @@ bool targetreached = false;
 void initMovement()
 {
     // Enable clocks
-    SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R1;
-    SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R0;
-
-    SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R1;
     SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R2;
     SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R3;
     SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R4;
@@ -105,16 +120,8 @@ void initMovement()
     SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R0;
     SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1;
     SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R2;
-    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R3;
-    SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R3;
     _delay_cycles(3);
 
-    //Configure ultra-sonic sensor:
-    GPIO_PORTB_DIR_R |= TRIG_MASK;
-    GPIO_PORTB_DIR_R &= ~ECHO_MASK;
-    GPIO_PORTB_DEN_R |= TRIG_MASK | ECHO_MASK;
-
-
     // Configure Right Motor and Right Collector:
     GPIO_PORTC_DEN_R |= RIGHT_MOTOR2 | RIGHT_MOTOR1 | LEFT_COLLECTOR;
     GPIO_PORTC_DIR_R &= ~LEFT_COLLECTOR;
@@ -124,13 +131,14 @@ void initMovement()
     GPIO_PORTC_PCTL_R |= GPIO_PCTL_PC4_M0PWM6 | GPIO_PCTL_PC5_M0PWM7;
 
     // Configure Left Motor and Left Collector and IR Detector:
-    GPIO_PORTD_DEN_R |= LEFT_MOTOR2 | LEFT_MOTOR1 | RIGHT_COLLECTOR | IR_DETECTOR;
-    GPIO_PORTD_DIR_R &= ~(RIGHT_COLLECTOR | IR_DETECTOR);
+    GPIO_PORTD_DEN_R |= LEFT_MOTOR2 | LEFT_MOTOR1 | RIGHT_COLLECTOR;
+    GPIO_PORTD_DIR_R &= ~RIGHT_COLLECTOR;
     GPIO_PORTD_PDR_R |= RIGHT_COLLECTOR;
     GPIO_PORTD_AFSEL_R |= LEFT_MOTOR2 | LEFT_MOTOR1;
     GPIO_PORTD_PCTL_R &= ~(GPIO_PCTL_PD0_M | GPIO_PCTL_PD1_M);
     GPIO_PORTD_PCTL_R |= GPIO_PCTL_PD0_M1PWM0 | GPIO_PCTL_PD1_M1PWM1;
 
+#if ENCODER_SOFTWARE_COUNT
     //Configure falling edge interrupts on collector inputs
     GPIO_PORTC_IS_R &= ~LEFT_COLLECTOR;
     GPIO_PORTC_IBE_R &= ~LEFT_COLLECTOR;
@@ -139,12 +147,13 @@ void initMovement()
     GPIO_PORTC_IM_R |= LEFT_COLLECTOR;
     NVIC_EN0_R = 1 << (INT_GPIOC-16);
 
-    GPIO_PORTD_IS_R &= ~(RIGHT_COLLECTOR | IR_DETECTOR);
-    GPIO_PORTD_IBE_R &= ~(RIGHT_COLLECTOR | IR_DETECTOR);
-    GPIO_PORTD_IEV_R &= ~(RIGHT_COLLECTOR | IR_DETECTOR);
-    GPIO_PORTD_ICR_R = RIGHT_COLLECTOR | IR_DETECTOR;
-    GPIO_PORTD_IM_R |= RIGHT_COLLECTOR | IR_DETECTOR;
+    GPIO_PORTD_IS_R &= ~RIGHT_COLLECTOR;
+    GPIO_PORTD_IBE_R &= ~RIGHT_COLLECTOR;
+    GPIO_PORTD_IEV_R &= ~RIGHT_COLLECTOR;
+    GPIO_PORTD_ICR_R = RIGHT_COLLECTOR;
+    GPIO_PORTD_IM_R |= RIGHT_COLLECTOR;
     NVIC_EN0_R = 1 << (INT_GPIOD-16);
+#endif
 
     // Configure SLEEP on H-Bridge and PIR Sensor:
     GPIO_PORTE_DIR_R |= SLEEP_MASK;
@@ -157,48 +166,14 @@ void initMovement()
     GPIO_PORTF_DEN_R |= RED_LED_MASK | GREEN_LED_MASK | BLUE_LED_MASK;
     GPIO_PORTF_DIR_R |= RED_LED_MASK | GREEN_LED_MASK | BLUE_LED_MASK;
 
-    // Right Motor 1 on M0PWM6 (C4), M0PWM3a
-    // Right Motor 2 on M0PWM7 (C5), M0PWM3b
-    // Left Motor 1 on M1PWM0 (D0), M1PWM0a
-    // Left Motor 2 on M1PWM1 (D1), M1PWM0b
-    SYSCTL_SRPWM_R = SYSCTL_SRPWM_R1;                // reset PWM1 module
-    SYSCTL_SRPWM_R = SYSCTL_SRPWM_R0;                // reset PWM0 module
-    SYSCTL_SRPWM_R = 0;                              // leave reset state
-    PWM0_3_CTL_R = 0;                                // turn-off PWM0 generator 3 (drives outs 6 and 7)
-    PWM1_0_CTL_R = 0;                                // turn-off PWM1 generator 0 (drives outs 1 and 2)
-                                                     // output 7 on PWM1, gen 3b, cmpb
-    PWM0_3_GENA_R = PWM_0_GENA_ACTCMPAD_ONE | PWM_0_GENA_ACTLOAD_ZERO;
-                                                     // output 5 on PWM0, gen 3a, cmpa
-    PWM0_3_GENB_R = PWM_0_GENB_ACTCMPBD_ONE | PWM_0_GENB_ACTLOAD_ZERO;
-                                                     // output 6 on PWM0, gen 3b, cmpb
-    PWM1_0_GENA_R = PWM_1_GENA_ACTCMPAD_ONE | PWM_1_GENA_ACTLOAD_ZERO;
-                                                     // output 0 on PWM1, gen 0a, cmpa
-    PWM1_0_GENB_R = PWM_1_GENB_ACTCMPBD_ONE | PWM_1_GENB_ACTLOAD_ZERO;
-                                                     // output 1 on PWM1, gen 0b, cmpb
-
-    //Set load
-    PWM0_3_LOAD_R = 1024;
-    PWM1_0_LOAD_R = 1024;
-
-    //RIGHT MOTOR                                    //Right Motor off
-    PWM0_3_CMPA_R = 0;
-    PWM0_3_CMPB_R = 0;
-
-    //LEFT MOTOR                                     //Left Motor off
-    PWM1_0_CMPA_R = 0;
-    PWM1_0_CMPB_R = 0;
-
-    //LEDS and Motors:
-    PWM0_3_CTL_R = PWM_0_CTL_ENABLE;                 // turn-on PWM0 generator 3
-    PWM1_0_CTL_R = PWM_1_CTL_ENABLE;                 // turn-on PWM1 generator 0
-    PWM0_ENABLE_R = PWM_ENABLE_PWM6EN | PWM_ENABLE_PWM7EN; //enable outputs
-    PWM1_ENABLE_R = PWM_ENABLE_PWM0EN | PWM_ENABLE_PWM1EN; // | PWM_ENABLE_PWM5EN | PWM_ENABLE_PWM6EN | PWM_ENABLE_PWM7EN;
-                                                     // enable outputs
+    initMotors();
+
+#if ENCODER_SOFTWARE_COUNT
     //Timer 1:
     TIMER1_CTL_R &= ~TIMER_CTL_TAEN;                 // turn-off timer before reconfiguring
     TIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;           // configure as 32-bit timer (A+B)
     TIMER1_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;          // configure for one - shot
-    TIMER1_TAILR_R = 1000000;                        // set load value to 1e6 for 40 Hz interrupt rate
+    TIMER1_TAILR_R = ENCODER_DEBOUNCE_MAX_US * TICKS_PER_US; // reloaded after each edge from the wheel speed
     TIMER1_IMR_R = TIMER_IMR_TATOIM;
     NVIC_EN0_R = 1 << (INT_TIMER1A-16);              // turn-on interrupt 37 (TIMER1A)
 
@@ -206,138 +181,150 @@ void initMovement()
     TIMER2_CTL_R &= ~TIMER_CTL_TAEN;                 // turn-off timer before reconfiguring
     TIMER2_CFG_R = TIMER_CFG_32_BIT_TIMER;           // configure as 32-bit timer (A+B)
     TIMER2_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;          // configure for one - shot
-    TIMER2_TAILR_R = 1000000;                        // set load value to 1e6 for 40 Hz interrupt rate
+    TIMER2_TAILR_R = ENCODER_DEBOUNCE_MAX_US * TICKS_PER_US; // reloaded after each edge from the wheel speed
     TIMER2_IMR_R = TIMER_IMR_TATOIM;
     NVIC_EN0_R = 1 << (INT_TIMER2A-16);              // turn-on interrupt 39 (TIMER2A)
+#endif
+}
 
-    //Timer 3:
-    TIMER3_CTL_R &= ~TIMER_CTL_TAEN;                 // turn-off timer before reconfiguring
-    TIMER3_CFG_R = TIMER_CFG_32_BIT_TIMER;           // configure as 32-bit timer (A+B)
-    TIMER3_TAMR_R = TIMER_TAMR_TAMR_PERIOD;          // configure for periodic mode (count down)
-    TIMER3_TAILR_R = 0xFFFFFFFF;                       // set load value to 40e6 for 1 Hz interrupt rate
-    TIMER3_IMR_R = TIMER_IMR_TATOIM;                 // turn-on interrupts for timeout in timer module
-    TIMER3_CTL_R |= TIMER_CTL_TAEN;                  // turn-on timer
-//    NVIC_EN1_R = 1 << (INT_TIMER3A-16-51);              // turn-on interrupt 37 (TIMER1A) in NVIC
-
-
-    // Configure Wide Timer 3 as counter of external events on CCP0 pin
-    WTIMER3_CTL_R &= ~TIMER_CTL_TAEN;                // turn-off counter before reconfiguring
-    WTIMER3_CFG_R = 4;                               // configure as 32-bit counter (A only)
-    WTIMER3_TAMR_R = TIMER_TAMR_TACMR | TIMER_TAMR_TAMR_CAP | TIMER_TAMR_TACDIR; // configure for edge count mode, count up
-    WTIMER3_CTL_R = TIMER_CTL_TAEVENT_NEG;           // count positive edges
-    WTIMER3_IMR_R = TIMER_IMR_CAEIM;                 // turn-off interrupts
-    WTIMER3_CTL_R |= TIMER_CTL_TAEN;                 // turn-on counter
-    WTIMER3_TAV_R = 0;                               // zero counter for first period
-    NVIC_EN3_R |= 1 << (INT_WTIMER3A-16-100);         // turn-on interrupt 112 (WTIMER1A)
-
-
+// Stop strategy for every later stop, holdMs is how long the stop is held
+// before the bridge sleeps (and the overshoot is read)
+void setStopMode(STOP_MODE mode, uint32_t holdMs)
+{
+    stopMode = mode;
+    stopHoldTicks = holdMs * CONTROL_HZ / 1000;
+}
 
+STOP_MODE getStopMode()
+{
+    return stopMode;
+}
 
+bool isStopping()
+{
+    return stopPhase != STOP_IDLE;
 }
 
-void LeftFallingEdgeIsr()
+// Ticks each wheel travelled past the target of the last move (past the
+// stop command for stop()), valid once isStopping() is false
+int32_t getOvershoot(uint8_t wheel)
 {
-    GREEN_LED ^= 1;
+    return overshoot[wheel];
+}
 
-    leftcount++;
+static void driveStop()
+{
+    uint8_t i;
 
-    if((leftcount >= limit) && (limit != -1))
+    __asm(" CPSID I");
+    for(i = 0; i < ENCODER_COUNT; i++)
     {
-        SLEEP_BUTTON = 0;
-        targetreached = true;
+        if(stopPhase == STOP_PULSE && pulseDir[i] != 0)
+            stageMotor(i, pulseDir[i] * STOP_PULSE_PWM);
+        else if(stopMode == STOP_COAST)
+            stageMotor(i, 0);
+        else
+            stageMotorBrake(i);
     }
-
-
-    GPIO_PORTC_IM_R &= ~LEFT_COLLECTOR;              // turn-off GPIO interrupt
-    TIMER1_CTL_R |= TIMER_CTL_TAEN;                  // turn-on one shot timer
-    GPIO_PORTC_ICR_R = LEFT_COLLECTOR;              // clear interrupt
+    commitMotors();
+    __asm(" CPSIE I");
 }
-void RightFallingEdgeIsr()
+
+// Halt the wheels with the selected strategy; the control loop runs the
+// rest of the sequence through updateStop() and then lets the bridge sleep
+static void beginStop()
 {
+    int32_t target;
+    uint8_t i;
+    bool pulse = false;
 
-    if(GPIO_PORTD_MIS_R & 4)
+    for(i = 0; i < ENCODER_COUNT; i++)
     {
+        target = getWheelTarget(i);
+        pulseDir[i] = stopMode != STOP_REVERSE ? 0 : target > 0 ? -1 : target < 0 ? 1 : 0;
+        pulse |= pulseDir[i] != 0;
+    }
+    stopControl();
+    if(!SLEEP_BUTTON)
+        return;                                      // already asleep, nothing to stop
+    stopLimit = limit;
+    stopTimer = 0;
+    stopPhase = pulse ? STOP_PULSE : STOP_HOLD;
+    driveStop();
+}
 
-        ADDR = 0;
-        ADDRNOT = 0;
-        DATA = 0;
-        DATANOT = 0;
+static void reachTarget()
+{
+    moveActive = false;
+    targetreached = true;
+    beginStop();
+}
 
+// Called from the control loop; returns true while the stop sequence owns
+// the motor outputs
+bool updateStop()
+{
+    uint8_t i;
+    bool pulsing = false;
 
-        if(WTIMER3_TAV_R >80*TICKS_PER_MS)
-        {
-            count = 0;
-        }
-        if(count == 0)
-        {
-            WTIMER3_TAV_R = 0;
-        }
-        time[count] = WTIMER3_TAV_R;
+    if(stopPhase == STOP_IDLE)
+        return false;
 
-        if(count == 0)
-        {
-            count++;
-        }
-        else if(count == 1)
+    stopTimer++;
+    if(stopPhase == STOP_PULSE)
+    {
+        for(i = 0; i < ENCODER_COUNT; i++)
         {
-            uint32_t t = time[1] - time[0];
-
-            if((t >= 13*TICKS_PER_MS) && (t <= 14*TICKS_PER_MS))
-                count++;
-            else
-                count = 0;
+            if(pulseDir[i] != 0 && (stopTimer >= STOP_PULSE_MS * CONTROL_HZ / 1000
+                                    || getWheelSpeed(i) < STOP_PULSE_END_MMS))
+                pulseDir[i] = 0;
+            pulsing |= pulseDir[i] != 0;
         }
-        else if(count>1)
+        if(!pulsing)
         {
-            uint32_t data = time[count]-time[count-1];
-            if((data>1.5*T && data<2.5*T) || (data>3.5*T && data<4.5*T))
-                count++;
-            else
-                count = 0;
+            stopPhase = STOP_HOLD;
+            stopTimer = 0;
         }
-        if (count == 34)
-        {
-            count = 0;
-            int i;
-
-            for(i = 1; i <= 34; i++)
-            {
-                uint32_t t = time[i+1]-time[i];
-
-                if(t>(1.5*T) && t<(2.5*T))  //0
-                    newcode |= 0 << (i-1);
-                else if(t>(3.5*T) && t<(4.5*T))  //1
-                    newcode |= 1 << (i-1);
-            }
-
-            ADDR = newcode >> 0;
-            ADDRNOT = newcode >> 8;
-            DATA = newcode >> 16;
-            DATANOT = newcode >> 24;
-            newcode = 0;
-            waitMicrosecond(10000);
-
-            remote();
+    }
+    else if(stopTimer >= stopHoldTicks)
+    {
+        overshoot[ENCODER_LEFT] = stopLimit == NO_LIMIT ? leftcount : leftcount - (int32_t)stopLimit;
+        overshoot[ENCODER_RIGHT] = stopLimit == NO_LIMIT ? rightcount : rightcount - (int32_t)stopLimit;
+        setMotors(0, 0);
+        SLEEP_BUTTON = 0;
+        stopPhase = STOP_IDLE;
+        return true;
+    }
+    driveStop();
+    return true;
+}
 
-        }
+void LeftFallingEdgeIsr()
+{
+    leftcount += encoderEdge(ENCODER_LEFT, getTicks());
+    GREEN_LED ^= 1;
 
+    if(moveActive && (uint32_t)leftcount >= limit)
+        reachTarget();
 
-        GPIO_PORTD_ICR_R = IR_DETECTOR;                     // clear interrupt flag
-        WTIMER3_ICR_R = TIMER_ICR_CAECINT;
 
-    }
+    GPIO_PORTC_IM_R &= ~LEFT_COLLECTOR;              // turn-off GPIO interrupt
+    TIMER1_TAILR_R = getDebounceTicks(ENCODER_LEFT, abs(getWheelTarget(ENCODER_LEFT)));
+    TIMER1_CTL_R |= TIMER_CTL_TAEN;                  // turn-on one shot timer
+    GPIO_PORTC_ICR_R = LEFT_COLLECTOR;              // clear interrupt
+}
+void RightFallingEdgeIsr()
+{
     if(GPIO_PORTD_MIS_R & 64)
     {
+        rightcount += encoderEdge(ENCODER_RIGHT, getTicks());
         BLUE_LED ^= 1;
-        rightcount++;
 
-        if((rightcount >= limit) && (limit != -1))
-        {
-            SLEEP_BUTTON = 0;
-            targetreached = true;
-        }
+        if(moveActive && (uint32_t)rightcount >= limit)
+            reachTarget();
 
         GPIO_PORTD_IM_R &= ~(RIGHT_COLLECTOR);              // turn-off GPIO interrupt
+        TIMER2_TAILR_R = getDebounceTicks(ENCODER_RIGHT, abs(getWheelTarget(ENCODER_RIGHT)));
         TIMER2_CTL_R |= TIMER_CTL_TAEN;                  // turn-on one shot timer
         GPIO_PORTD_ICR_R = RIGHT_COLLECTOR;              // clear interrupt
 
@@ -345,6 +332,8 @@ void RightFallingEdgeIsr()
 }
 void LeftDebounceIsr()
 {
+    if(GPIO_PORTC_RIS_R & LEFT_COLLECTOR)            // an edge latched during the lockout
+        encoderBounce(ENCODER_LEFT);
     GPIO_PORTC_ICR_R = LEFT_COLLECTOR;
     GPIO_PORTC_IM_R |= LEFT_COLLECTOR;
     TIMER1_ICR_R = TIMER_ICR_TATOCINT;
@@ -352,122 +341,170 @@ void LeftDebounceIsr()
 }
 void RightDebounceIsr()
 {
+    if(GPIO_PORTD_RIS_R & RIGHT_COLLECTOR)           // an edge latched during the lockout
+        encoderBounce(ENCODER_RIGHT);
     GPIO_PORTD_ICR_R = RIGHT_COLLECTOR;
     GPIO_PORTD_IM_R |= RIGHT_COLLECTOR;
     TIMER2_ICR_R = TIMER_ICR_TATOCINT;
 }
 
-void forward(int speed, int distance)
+// Start the per-move tick counts from zero, also cancels a stop in progress
+static void resetCounts()
 {
+    moveActive = false;
+    stopPhase = STOP_IDLE;
+#if !ENCODER_SOFTWARE_COUNT
+    moveBase[ENCODER_LEFT] = getEncoderCount(ENCODER_LEFT);
+    moveBase[ENCODER_RIGHT] = getEncoderCount(ENCODER_RIGHT);
+#endif
     leftcount = 0;
     rightcount = 0;
+}
+
+// With hardware counting there is no interrupt per edge, so the control loop
+// derives the per-move counts and checks the tick target after each sample
+void updateMoveLimit()
+{
+#if !ENCODER_SOFTWARE_COUNT
+    leftcount = getEncoderCount(ENCODER_LEFT) - moveBase[ENCODER_LEFT];
+    rightcount = getEncoderCount(ENCODER_RIGHT) - moveBase[ENCODER_RIGHT];
+    if(moveActive && ((uint32_t)leftcount >= limit || (uint32_t)rightcount >= limit))
+        reachTarget();
+#endif
+}
+
+// Ramp to speed (mm/s) and back down onto the tick target; a move shorter
+// than half a tick is carried over without turning the wheels
+static void startMove(int8_t leftDir, int8_t rightDir, int speed)
+{
+    if(limit == 0)
+    {
+        stopControl();
+        SLEEP_BUTTON = 0;
+        targetreached = true;
+        return;
+    }
+    moveActive = limit != NO_LIMIT;
+    startProfile(leftDir, rightDir, limit == NO_LIMIT ? 0 : limit, speed, PROFILE_ACCEL, PROFILE_JERK);
+}
+
+void forward(int speed, int distance)
+{
+    resetCounts();
+    resetHeading();
 
     // Wake from SLEEP
     SLEEP_BUTTON = 1;
 
-    // Configure motor PWM based on speed
-    PWM0_3_CMPA_R = 0;           // Assuming configuration for forward direction
-    PWM0_3_CMPB_R = speed - 29;  // Speed adjustment for motor characteristics
-    PWM1_0_CMPA_R = speed;       // Same here
-    PWM1_0_CMPB_R = 0;           // Assuming configuration for forward direction
-
     if(distance != 0)
     {
-        limit = ((distance*10) / 245) * 2;  // Calculate the necessary count for given distance
+        limit = distanceToTicks(distance);  // rounded, the remainder is carried to the next move
 
     }
     else
     {
-        limit = -1;
+        limit = NO_LIMIT;
     }
+
+    startMove(1, 1, speed);
 }
 
 void reverse(int speed, int distance)
 {
-    leftcount = 0;
-    rightcount = 0;
+    resetCounts();
+    resetHeading();
 
     //Wake from SLEEP
     SLEEP_BUTTON = 1;
 
-    //RIGHT MOTOR
-    PWM0_3_CMPA_R = speed - 34;
-    PWM0_3_CMPB_R = 0;
-
-    //LEFT MOTOR
-    PWM1_0_CMPA_R = 0;
-    PWM1_0_CMPB_R = speed;
-
     if(distance != 0)
     {
-        limit = ((distance*10) / 245) * 2;  // Calculate the necessary count for given distance
+        limit = distanceToTicks(-distance); // rounded, the remainder is carried to the next move
     }
     else
     {
-        limit = -1;
+        limit = NO_LIMIT;
     }
+
+    startMove(-1, -1, speed);
 }
 
 void ccw(int speed, int angle)
 {
 
-    leftcount = 0;
-    rightcount = 0;
+    resetCounts();
+    resetHeading();
 
     //Wake from SLEEP
     SLEEP_BUTTON = 1;
 
-    //RIGHT MOTOR
-    PWM0_3_CMPA_R = 0;
-    PWM0_3_CMPB_R = speed - 35;
-
-    //LEFT MOTOR
-    PWM1_0_CMPA_R = 0;
-    PWM1_0_CMPB_R = speed;
-
     if(angle != 0)
     {
-        limit = ((2* angle) / 73) * 3;  // Calculate the necessary count for given distance
+        limit = angleToTicks(angle);        // rounded, the remainder is carried to the next turn
     }
     else
     {
-        limit = -1;
+        limit = NO_LIMIT;
     }
+
+    startMove(-1, 1, speed);
 }
 
 void cw(int speed, int angle)
 {
 
-    leftcount = 0;
-    rightcount = 0;
+    resetCounts();
+    resetHeading();
 
     //Wake from SLEEP
     SLEEP_BUTTON = 1;
 
-    //LEFT MOTOR
-    PWM1_0_CMPA_R = speed;
-    PWM1_0_CMPB_R = 0;
-
-    //RIGHT MOTOR
-    PWM0_3_CMPA_R = speed;
-    PWM0_3_CMPB_R = 0;
-
     if(angle != 0)
     {
-        limit = ((2* angle) / 73) * 3;  // Calculate the necessary count for given distance
+        limit = angleToTicks(-angle);       // rounded, the remainder is carried to the next turn
     }
     else
     {
-        limit = -1;
+        limit = NO_LIMIT;
     }
+
+    startMove(1, -1, speed);
 }
 
+// Stop with the selected stop mode. A stop already in progress (such as the
+// one started when a move reached its target) is left to finish, so its hold
+// time and overshoot are not lost; a fresh stop counts the overshoot from here.
 void stop()
 {
-    leftcount = 0;
-    rightcount = 0;
+    if(moveActive || !isMotionDone())
+        clearKinematicsCarry();                      // cut short, the carry no longer matches the wheels
+    clearSegments();
+    if(isStopping())
+        return;
+    resetCounts();
+    limit = NO_LIMIT;
+    beginStop();
+}
 
-    SLEEP_BUTTON = 0;
+// Bring the robot to rest when the segment queue runs dry, through the same
+// stop sequence as a direct move; the overshoot counts from the end of the
+// last segment. Called from the control ISR.
+void finishQueuedMove()
+{
+    resetCounts();
+    limit = NO_LIMIT;
+    targetreached = true;
+    beginStop();
+}
+
+// Enable the drivers for moves queued as segments, which end on their own
+// count targets rather than the edge ISR limit
+void wakeMotors()
+{
+    stopPhase = STOP_IDLE;
+    limit = NO_LIMIT;
+    targetreached = false;
+    SLEEP_BUTTON = 1;
 }
 
 
@@ -476,49 +513,101 @@ void initHw()
     // Initialize system clock to 40 MHz
     initSystemClockTo40Mhz();
 }
-void sendPulse()
+typedef enum _NAV_STATE
 {
-    TRIG_PIN = 1;
-    waitMicrosecond(10);
-    TRIG_PIN = 0;
+    NAV_IDLE,
+    NAV_TURNING,                                   // quarter turn to the next heading queued
+    NAV_SAMPLING,                                  // collecting pings taken after the turn
+    NAV_FACING,                                    // turning to the clearest heading
+    NAV_PAUSED,                                    // someone in front, waiting before driving
+    NAV_DRIVING
+} NAV_STATE;
+
+static NAV_STATE navState = NAV_IDLE;
+static int navRange[4][2];                         // range and quarter turn count per heading
+static uint8_t navStep;
+static uint8_t navSamples;
+static uint16_t navStart;                          // heading navigate() started from
+static uint32_t navTime;                           // tick the current wait started
+static uint32_t navSeq;                            // sequence number of the last ping used
+static MEDIAN_FILTER navMedian;
+
+static void faceClearest();
+
+static bool remoteDriving = false;
+static uint32_t remoteTime = 0;                    // capture time of the last frame of the held button
+static uint32_t remoteHold = 0;
+
+// Frames repeat at a fixed period while a button is held, the dead-man gap
+// is that period plus a little slack for the remote's resonator (about
+// 112 ms for NEC). Gaps are timed from the frame captures, so the main loop
+// poll does not add to them.
+static uint32_t getRemoteHoldTicks(IR_PROTOCOL protocol)
+{
+    switch(protocol)
+    {
+    case IR_RC5:
+        return (RC5_REPEAT_PERIOD_MS + REMOTE_HOLD_SLACK_MS) * TICKS_PER_MS;
+    case IR_SIRC:
+        return (SIRC_REPEAT_PERIOD_MS + REMOTE_HOLD_SLACK_MS) * TICKS_PER_MS;
+    default:
+        return (NEC_REPEAT_PERIOD_MS + REMOTE_HOLD_SLACK_MS) * TICKS_PER_MS;
+    }
 }
 
-uint32_t measure_mm()
+void remote(const IR_EVENT *event)
 {
-    uint32_t start, end, duration, dist;
-
-    sendPulse();
-    while(!ECHO_PIN);
-    start = TIMER3_TAR_R;
-    while(ECHO_PIN);
-    end = TIMER3_TAR_R;
-
-    duration = start - end;
-    dist = (duration * 0.34 * 0.025) / 2;
+    remoteTime = event->time;
+    remoteHold = getRemoteHoldTicks(event->protocol);
+    remoteDriving = true;
+    switch(DATA)
+    {
+    case ACTION_FORWARD:
+        forward(CRUISE_SPEED, 0);
+        break;
+    case ACTION_REVERSE:
+        reverse(CRUISE_SPEED, 0);
+        break;
+    case ACTION_CCW:
+        ccw(CRUISE_SPEED, 0);
+        break;
+    case ACTION_CW:
+        cw(CRUISE_SPEED, 0);
+        break;
+    case ACTION_STOP:
+        remoteDriving = false;
+        navState = NAV_IDLE;
+        stop();
+        break;
+    case ACTION_NAVIGATE:
+        remoteDriving = false;
+        navigate();                                  // updateNavigate() runs the rest from the main loop
+        break;
+    case ACTION_WALLPING:
+        remoteDriving = false;
+        wallpingtest();
+        break;
+    default:
+        remoteDriving = false;
+        break;
+    }
+}
 
-    return dist;
+// Repeat frame while a button is held, keeps the current drive command alive
+void remoteRepeat(const IR_EVENT *event)
+{
+    if(remoteDriving)
+        remoteTime = event->time;
 }
-void remote()
+
+// Dead-man check, stops a remote drive once the button has been released
+void remoteCheck()
 {
-    if(DATA == 64)
+    if(remoteDriving && ticksSince(remoteTime) > remoteHold)
     {
-        forward(1023, 0);
-    }
-    else if(DATA == 65)
-        reverse(1023, 0);
-    else if(DATA == 7)
-        ccw(1023, 0);
-    else if(DATA == 6)
-        cw(1023, 0);
-    else if(DATA == 68)
+        remoteDriving = false;
         stop();
-//    else if(DATA == 16)
-//    {
-//       valid ^= 1;
-//    }
-    else
-        waitMicrosecond(100);
-
+    }
 }
 bool motion_sense()
 {
@@ -533,20 +622,6 @@ bool motion_sense()
         return false;
     }
 }
-int speedToPWMLoad(int speed){
-    // Constants calculated from the linear relationship
-    double m = (10000.0 - 3000.0) / (1023.0 - 750.0);
-    double b = 10000.0 - m * 1023.0;
-
-    // Calculate PWM load
-    int pwmLoad = (int)((speed - b) / m + 0.5);  // Adding 0.5 for rounding to nearest integer
-
-    // Ensuring PWM load is within the allowed range
-    if (pwmLoad > 1023) pwmLoad = 1023;
-    if (pwmLoad < 750) pwmLoad = 750;
-
-    return pwmLoad;
-}
 void swapRows(int arr[][2], int row1, int row2, int colCount) {
     int i;
     for(i = 0; i < colCount; i++)
@@ -574,62 +649,123 @@ void selectionSort2D(int arr[][2], int rowCount, int colCount) {
 }
 
 
+// Pick the clearest of the four quarter headings and drive that way. With
+// one sensor the robot turns to each heading; each one is scored from
+// pings sent after the turn finished, through a median of their own so the
+// outlier filter's window from the last heading does not leak in. The
+// steps run from updateNavigate() in the main loop, nothing busy-waits.
 void navigate()
 {
-        int arr[4][2];
+#if RANGE_SENSOR_COUNT >= 4
+    uint8_t i;
+#endif
+
+    if(navState != NAV_IDLE)
+        return;
+    navStart = getHeading();
+    navStep = 0;
+#if RANGE_SENSOR_COUNT >= 4
+    // Heading (i + 1) * 90 clockwise is seen by the next sensor clockwise
+    for(i = 0; i < 4; i++)
+    {
+        navRange[i][0] = getFilteredRangeMm((i + 1) % 4);
+        navRange[i][1] = i + 1;
+    }
+    faceClearest();
+#else
+    queueTurn(-90, CRUISE_SPEED);
+    navState = NAV_TURNING;
+#endif
+}
+
+// Turn from the heading odometry reports, not from the assumption that the
+// four quarter turns added up to a full circle
+static void faceClearest()
+{
+    selectionSort2D(navRange, 4, 2);
+    queueTurn(-ANGLE_TO_DEG((uint16_t)(getHeading() - (navStart - navRange[3][1] * ANGLE_90))), CRUISE_SPEED);
+    navState = NAV_FACING;
+}
 
-        int temp;
-        int dist1;
-        int dist2;
-        int dist3;
-        int reqDist;
+// Advance the navigate sequence on motion-complete and range-ready events
+void updateNavigate()
+{
+    RANGE_SAMPLE sample;
+    uint32_t seq;
 
-        int a = 0;
-        while(a < 4)
+    switch(navState)
+    {
+    case NAV_TURNING:
+        if(isMotionDone())
         {
-            cw(1023, 90);
-            waitMicrosecond(750000);
-            dist1 = measure_mm();
-            dist2 = measure_mm();
-            dist3 = measure_mm();
-            reqDist = (dist1 + dist2 + dist3) / 3;
-
-
-            arr[a][0] = reqDist;
-            arr[a][1] = a + 1;
-            waitMicrosecond(250000);
-            a++;
+            navTime = getTicks();
+            initMedianFilter(&navMedian, NAVIGATE_SAMPLES);
+            navSamples = 0;
+            navState = NAV_SAMPLING;
         }
-
-        selectionSort2D(arr, 4, 2);
-        int reqAngle = (arr[3][1]) * 90;
-        reqDist = arr[3][0];
-        temp = arr[3][0];
-
-        cw(1023, reqAngle);
-        waitMicrosecond(500000);
-        if(motion_sense())
+        break;
+    case NAV_SAMPLING:
+        // A ping already in flight when the turn ended saw the old heading
+        seq = getRange(RANGE_FRONT, &sample);
+        if(seq == navSeq || (int32_t)(sample.time - navTime) < (int32_t)(RANGE_SLOT_US * TICKS_PER_US))
+            break;
+        navSeq = seq;
+        medianFilter(&navMedian, sample.mm);
+        if(++navSamples < NAVIGATE_SAMPLES)
+            break;
+        navRange[navStep][0] = getMedian(&navMedian);
+        navRange[navStep][1] = navStep + 1;
+        if(++navStep < 4)
         {
-            waitMicrosecond(3000000);
+            queueTurn(-90, CRUISE_SPEED);
+            navState = NAV_TURNING;
         }
-        forward(1023, reqDist);
-        while(temp >= 200)
+        else
+            faceClearest();
+        break;
+    case NAV_FACING:
+        if(isMotionDone())
         {
-            temp = measure_mm();
+            navTime = getTicks();
+            navState = motion_sense() ? NAV_PAUSED : NAV_DRIVING;
         }
-        stop();
-
+        break;
+    case NAV_PAUSED:
+        if(ticksSince(navTime) >= NAVIGATE_PAUSE_MS * TICKS_PER_MS)
+            navState = NAV_DRIVING;
+        break;
+    case NAV_DRIVING:
+        navState = NAV_IDLE;
+        guardedForward(CRUISE_SPEED, navRange[3][0]);
+        break;
+    default:
+        break;
+    }
 }
 void wallpingtest()
 {
-    int temp = 300;
-    forward(1023, 0);
-    while(temp >= 200)
+    guardedForward(CRUISE_SPEED, 0);
+}
+// Drive forward until the distance is covered or the range rate says to brake
+void guardedForward(int speed, int distance)
+{
+    APPROACH_INFO info;
+    APPROACH_STATE state = APPROACH_CLEAR;
+
+    initApproach();
+    targetreached = false;
+    forward(speed, distance);
+    while(!targetreached && state != APPROACH_BRAKE)
     {
-        temp = measure_mm();
+        state = checkApproach(&info);
+        if(state == APPROACH_SLOW && speed > APPROACH_SLOW_SPEED)
+        {
+            speed = APPROACH_SLOW_SPEED;
+            setProfileSpeed(speed);
+        }
     }
     stop();
-
+    doneApproach();
 }
 
 
@@ -30,10 +30,24 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "ir.h"
 
 int leftcount;
 int rightcount;
-uint8_t DATA;
+#define CRUISE_SPEED 300                           // mm/s used by the remote and navigation
+#define STOP_HOLD_MS 150                           // default time to hold the stop before the bridge sleeps
+#define STOP_PULSE_MS 40                           // reverse pulse limit
+#define STOP_PULSE_PWM 800
+#define STOP_PULSE_END_MMS 40                      // reverse pulse ends once the wheel is this slow
+
+typedef enum _STOP_MODE
+{
+    STOP_COAST,                                    // both bridge inputs low, the wheels roll out
+    STOP_BRAKE,                                    // both bridge inputs high, windings shorted
+    STOP_REVERSE                                   // brief reverse drive, then short brake
+} STOP_MODE;
+
+uint8_t DATA;                                      // last remote action (REMOTE_ACTION)
 //static uint8_t valid = 0;
 
 //-----------------------------------------------------------------------------
@@ -47,10 +61,20 @@ void reverse(int speed, int distance);
 void ccw(int speed, int angle);
 void cw(int speed, int angle);
 void stop();
-uint32_t measure_mm();
-void remote();
+void wakeMotors();
+void finishQueuedMove();
+void updateMoveLimit();
+void setStopMode(STOP_MODE mode, uint32_t holdMs);
+STOP_MODE getStopMode();
+bool updateStop();
+bool isStopping();
+int32_t getOvershoot(uint8_t wheel);
+void remote(const IR_EVENT *event);
+void remoteRepeat(const IR_EVENT *event);
+void remoteCheck();
 bool motion_sense();
-int speedToPWMLoad(int speed);
 void navigate();
+void updateNavigate();
 void wallpingtest();
+void guardedForward(int speed, int distance);
 #endif
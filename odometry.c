@@ -0,0 +1,152 @@
+// Odometry Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, integrated from the encoder counts in the control loop interrupt
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "encoder.h"
+#include "kinematics.h"
+#include "odometry.h"
+
+// sin over the first quadrant in 64 steps (Q15), interpolated in between
+static const int16_t sinTable[65] =
+{
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+    6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+    12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+    23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+    27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+    32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+    32767
+};
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static POSE pose;
+static int32_t xFrac, yFrac;                       // sub-um remainders (Q15)
+static volatile uint32_t poseSeq = 0;              // odd while the pose is being written
+static uint32_t lastCount[ENCODER_COUNT];
+static int8_t lastDir[ENCODER_COUNT] = { 1, 1 };   // collectors are single channel, follow the drive
+static uint32_t umPerTickQ8;
+static uint32_t anglePerTickQ8;                    // heading change per tick of wheel difference
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+int16_t sinAngle(uint16_t angle)
+{
+    uint16_t r = angle & 0x3FFF;
+    uint8_t i;
+    int32_t v;
+
+    if(angle & 0x4000)
+        r = 0x4000 - r;                              // mirror the 2nd and 4th quadrants
+    i = r >> 8;
+    v = sinTable[i];
+    if(i < 64)
+        v += ((sinTable[i + 1] - v) * (r & 0xFF)) >> 8;
+    return (angle & 0x8000) ? -v : v;
+}
+
+int16_t cosAngle(uint16_t angle)
+{
+    return sinAngle(angle + ANGLE_90);
+}
+
+// Take the calibration from the kinematics model and start at the origin
+void initOdometry()
+{
+    KINEMATICS kin;
+
+    getKinematics(&kin);
+    umPerTickQ8 = kin.umPerTickQ8;
+    // (um per tick / track) radians, times 65536 / 2pi (pi as 355/113)
+    anglePerTickQ8 = ((uint64_t)kin.umPerTickQ8 * 65536 * 113 + (uint64_t)kin.trackUm * 355) / ((uint64_t)kin.trackUm * 2 * 355);
+    lastCount[ENCODER_LEFT] = getEncoderCount(ENCODER_LEFT);
+    lastCount[ENCODER_RIGHT] = getEncoderCount(ENCODER_RIGHT);
+    resetPose();
+}
+
+void resetPose()
+{
+    poseSeq++;
+    pose.x = 0;
+    pose.y = 0;
+    pose.theta = 0;
+    xFrac = 0;
+    yFrac = 0;
+    poseSeq++;
+}
+
+// Consistent copy of the pose, never blocks the control loop
+void getPose(POSE *copy)
+{
+    uint32_t seq;
+
+    do
+    {
+        seq = poseSeq;
+        *copy = pose;
+    } while((seq & 1) || seq != poseSeq);
+}
+
+uint16_t getHeading()
+{
+    return pose.theta;                               // a single halfword read is atomic
+}
+
+// Integrate the ticks since the last call, run at the control rate. The
+// wheel targets give the direction of each wheel's ticks (the last non-zero
+// one while a wheel coasts to a stop). Uses the heading at the middle of
+// the step, so a constant-curvature step is exact to first order.
+void updateOdometry(int32_t leftTarget, int32_t rightTarget)
+{
+    uint32_t left = getEncoderCount(ENCODER_LEFT);
+    uint32_t right = getEncoderCount(ENCODER_RIGHT);
+    int32_t dl, dr, d, dTheta;
+    uint16_t mid;
+
+    if(leftTarget != 0)
+        lastDir[ENCODER_LEFT] = leftTarget > 0 ? 1 : -1;
+    if(rightTarget != 0)
+        lastDir[ENCODER_RIGHT] = rightTarget > 0 ? 1 : -1;
+    dl = (int32_t)(left - lastCount[ENCODER_LEFT]) * lastDir[ENCODER_LEFT];
+    dr = (int32_t)(right - lastCount[ENCODER_RIGHT]) * lastDir[ENCODER_RIGHT];
+    lastCount[ENCODER_LEFT] = left;
+    lastCount[ENCODER_RIGHT] = right;
+    if(dl == 0 && dr == 0)
+        return;
+
+    d = ((dl + dr) * (int32_t)umPerTickQ8) >> 9;     // centre travel, um
+    dTheta = ((dr - dl) * (int32_t)anglePerTickQ8) >> 8;
+    mid = pose.theta + dTheta / 2;
+
+    poseSeq++;
+    xFrac += d * cosAngle(mid);
+    yFrac += d * sinAngle(mid);
+    pose.x += xFrac >> 15;
+    pose.y += yFrac >> 15;
+    xFrac &= 0x7FFF;
+    yFrac &= 0x7FFF;
+    pose.theta += dTheta;
+    poseSeq++;
+}
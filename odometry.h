@@ -0,0 +1,49 @@
+// Odometry Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, integrated from the encoder counts in the control loop interrupt
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef ODOMETRY_H_
+#define ODOMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Binary angle: a full turn is 65536, counter-clockwise positive
+#define ANGLE_90 16384
+#define ANGLE_TO_DEG(a) (((int32_t)(int16_t)(a) * 360 + 32768) >> 16)
+#define DEG_TO_ANGLE(d) ((uint16_t)(((int32_t)(d) * 65536 + 180) / 360))
+
+typedef struct _POSE
+{
+    int32_t x;                                     // um, along the starting heading
+    int32_t y;                                     // um, to the left of the starting heading
+    uint16_t theta;                                // binary angle
+} POSE;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initOdometry();
+void resetPose();
+void getPose(POSE *pose);
+uint16_t getHeading();
+void updateOdometry(int32_t leftTarget, int32_t rightTarget);
+int16_t sinAngle(uint16_t angle);
+int16_t cosAngle(uint16_t angle);
+
+#endif
@@ -0,0 +1,226 @@
+// Motion Profile Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, stepped from the control loop interrupt (Timer 4A)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "encoder.h"
+#include "control.h"
+#include "kinematics.h"
+#include "profile.h"
+
+// Window for the S-curve smoother, sets the lowest jerk: aMax * CONTROL_HZ / PROFILE_TAPS
+#define PROFILE_TAPS 64
+
+typedef struct _PROFILE
+{
+    bool active;
+    bool done;                                     // count target reached
+    int16_t scale[ENCODER_COUNT];                  // wheel speed per unit of profile speed (Q8, signed)
+    uint32_t base[ENCODER_COUNT];                  // encoder counts at the start
+    uint32_t targetCounts;                         // average of both wheels, 0 runs until stopped
+    uint32_t targetMm;
+    uint32_t vMax;                                 // mm/s
+    uint32_t vExit;                                // speed to arrive at, mm/s
+    uint32_t aMax;                                 // mm/s^2
+    int32_t vQ8;                                   // trapezoid speed, mm/s (Q8)
+    uint32_t posQ8;                                // trapezoid distance, mm (Q8)
+    uint32_t posFrac;                              // remainder of the position integration
+    uint32_t outQ8;                                // smoothed (output) distance, mm (Q8)
+    uint32_t outFrac;
+    uint16_t taps[PROFILE_TAPS];                   // recent trapezoid speeds, mm/s (Q4)
+    uint8_t tapCount;                              // window length, 1 for a plain trapezoid
+    uint8_t tapIndex;
+    uint32_t tapSum;
+    uint32_t outQ4;                                // smoothed speed, mm/s (Q4)
+} PROFILE;
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+// Shared with the control ISR; main only changes it with interrupts masked
+static volatile PROFILE profile;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static uint32_t isqrt(uint32_t x)
+{
+    uint32_t root = 0, bit = 1UL << 30;
+
+    while(bit > x)
+        bit >>= 2;
+    while(bit)
+    {
+        if(x >= root + bit)
+        {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+            root >>= 1;
+        bit >>= 2;
+    }
+    return root;
+}
+
+// Start a move of counts encoder edges per wheel (0 to run until stopped);
+// the setpoint starts from rest and is stepped each control tick
+void startProfile(int8_t leftDir, int8_t rightDir, uint32_t counts, uint32_t vMax, uint32_t aMax, uint32_t jerk)
+{
+    startProfileScaled(leftDir * 256, rightDir * 256, counts, vMax, aMax, jerk, false);
+}
+
+// Start a move where each wheel runs at scale / 256 of the profile speed,
+// counts being the average of the two wheels; with keepSpeed the setpoint
+// carries on from the current speed so consecutive moves blend
+void startProfileScaled(int16_t leftScale, int16_t rightScale, uint32_t counts, uint32_t vMax, uint32_t aMax, uint32_t jerk, bool keepSpeed)
+{
+    uint32_t taps = jerk ? aMax * CONTROL_HZ / jerk : 1;
+    uint32_t targetMm = ticksToUm(counts) / 1000;
+    uint8_t i;
+
+    __asm(" CPSID I");                               // the ISR must never see a half-written move
+    profile.active = false;
+    profile.done = false;
+    profile.scale[ENCODER_LEFT] = leftScale;
+    profile.scale[ENCODER_RIGHT] = rightScale;
+    profile.base[ENCODER_LEFT] = getEncoderCount(ENCODER_LEFT);
+    profile.base[ENCODER_RIGHT] = getEncoderCount(ENCODER_RIGHT);
+    profile.targetCounts = counts;
+    profile.targetMm = targetMm;
+    profile.vMax = vMax;
+    profile.vExit = 0;
+    profile.aMax = aMax;
+    profile.posQ8 = 0;
+    profile.posFrac = 0;
+    profile.outQ8 = 0;
+    profile.outFrac = 0;
+    if(!keepSpeed)
+    {
+        profile.vQ8 = 0;
+        profile.tapCount = taps < 1 ? 1 : taps > PROFILE_TAPS ? PROFILE_TAPS : taps;
+        profile.tapIndex = 0;
+        profile.tapSum = 0;
+        profile.outQ4 = 0;
+        for(i = 0; i < PROFILE_TAPS; i++)
+            profile.taps[i] = 0;
+    }
+    profile.active = true;                           // the control ISR picks it up from here
+    __asm(" CPSIE I");
+}
+
+// Speed to be at when the count target is reached, for blending into the next move
+void setProfileExitSpeed(uint32_t vExit)
+{
+    profile.vExit = vExit;
+}
+
+bool isProfileDone()
+{
+    return profile.done;
+}
+
+// Change the cruise speed of the running move, slowing at the profile acceleration
+void setProfileSpeed(uint32_t vMax)
+{
+    profile.vMax = vMax;
+}
+
+void stopProfile()
+{
+    profile.active = false;
+}
+
+bool isProfileActive()
+{
+    return profile.active;
+}
+
+uint32_t getProfileSpeed()
+{
+    return profile.outQ4 >> 4;
+}
+
+// Advance one control tick given the distance the trapezoid still has to
+// go (ignored for open-ended moves), returns the smoothed speed in mm/s.
+// The trapezoid decelerates on sqrt(2 a d) so it lands on the target; for
+// an S-curve it is passed through a moving average one ramp-time long,
+// which limits the jerk to aMax / window and keeps the distance unchanged.
+uint32_t profileStep(uint32_t remainingMm)
+{
+    int32_t vTarget = profile.vMax;
+    int32_t step = (profile.aMax << 8) / CONTROL_HZ;
+    int32_t stop;
+
+    if(profile.targetMm != 0)
+    {
+        stop = (int32_t)isqrt(profile.vExit * profile.vExit + 2 * profile.aMax * remainingMm);
+        if(stop < PROFILE_MIN_SPEED)
+            stop = PROFILE_MIN_SPEED;
+        if(vTarget > stop)
+            vTarget = stop;
+    }
+
+    if(profile.vQ8 < (vTarget << 8) - step)
+        profile.vQ8 += step;
+    else if(profile.vQ8 > (vTarget << 8) + step)
+        profile.vQ8 -= step;
+    else
+        profile.vQ8 = vTarget << 8;
+
+    profile.posFrac += profile.vQ8;
+    profile.posQ8 += profile.posFrac / CONTROL_HZ;
+    profile.posFrac %= CONTROL_HZ;
+
+    profile.tapSum += (profile.vQ8 >> 4) - profile.taps[profile.tapIndex];
+    profile.taps[profile.tapIndex] = profile.vQ8 >> 4;
+    profile.tapIndex = (profile.tapIndex + 1) % profile.tapCount;
+    profile.outQ4 = profile.tapSum / profile.tapCount;
+
+    profile.outFrac += profile.outQ4 << 4;
+    profile.outQ8 += profile.outFrac / CONTROL_HZ;
+    profile.outFrac %= CONTROL_HZ;
+
+    return profile.outQ4 >> 4;
+}
+
+// Called from the control ISR each tick, sets the wheel setpoints. If the
+// wheels get ahead of the setpoint the trapezoid is advanced to match, so
+// the move still lands on the count target.
+void updateProfile()
+{
+    uint32_t measured, ahead, done, counts;
+    int32_t v;
+
+    if(!profile.active)
+        return;
+
+    counts = ((getEncoderCount(ENCODER_LEFT) - profile.base[ENCODER_LEFT])
+            + (getEncoderCount(ENCODER_RIGHT) - profile.base[ENCODER_RIGHT])) / 2;
+    measured = ticksToUm(counts) / 1000;
+    ahead = measured > (profile.outQ8 >> 8) ? measured - (profile.outQ8 >> 8) : 0;
+    done = (profile.posQ8 >> 8) + ahead;
+
+    if(profile.targetCounts != 0 && counts >= profile.targetCounts)
+        profile.done = true;
+
+    v = profileStep(done < profile.targetMm ? profile.targetMm - done : 0);
+    setWheelSpeeds((profile.scale[ENCODER_LEFT] * v) >> 8, (profile.scale[ENCODER_RIGHT] * v) >> 8);
+}
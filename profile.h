@@ -0,0 +1,44 @@
+// Motion Profile Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, stepped from the control loop interrupt (Timer 4A)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PROFILE_ACCEL 600                          // default acceleration in mm/s^2
+#define PROFILE_JERK 3000                          // default jerk in mm/s^3, 0 for a trapezoid
+#define PROFILE_MIN_SPEED 60                       // creep speed for the last counts (encoder still reads it)
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void startProfile(int8_t leftDir, int8_t rightDir, uint32_t counts, uint32_t vMax, uint32_t aMax, uint32_t jerk);
+void startProfileScaled(int16_t leftScale, int16_t rightScale, uint32_t counts, uint32_t vMax, uint32_t aMax, uint32_t jerk, bool keepSpeed);
+void setProfileExitSpeed(uint32_t vExit);
+bool isProfileDone();
+void setProfileSpeed(uint32_t vMax);
+void stopProfile();
+bool isProfileActive();
+uint32_t getProfileSpeed();
+void updateProfile();
+uint32_t profileStep(uint32_t remainingMm);
+
+#endif
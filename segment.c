@@ -0,0 +1,204 @@
+// Motion Segment Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, consumed by the control loop interrupt (Timer 4A)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "movement.h"
+#include "control.h"
+#include "profile.h"
+#include "kinematics.h"
+#include "segment.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+// Single-producer (main loop) / single-consumer (control ISR) ring of segments
+static SEGMENT segments[SEGMENT_QUEUE_SIZE];
+static volatile uint8_t segmentHead = 0;
+static volatile uint8_t segmentTail = 0;
+static volatile bool segmentRunning = false;       // a segment is being driven
+static volatile bool clearRequest = false;         // main asked the ISR to drop the queue
+static volatile uint8_t clearHead;                 // head when the clear was asked for
+static SEGMENT current;
+static uint32_t holdLeft;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static bool pushSegment(const SEGMENT *segment)
+{
+    uint8_t head = segmentHead;
+
+    if((uint8_t)(head - segmentTail) >= SEGMENT_QUEUE_SIZE)
+        return false;
+    segments[head & (SEGMENT_QUEUE_SIZE-1)] = *segment;
+    if(clearRequest || (!segmentRunning && head == segmentTail))
+        wakeMotors();                                // idle, the control ISR starts it next tick
+    segmentHead = head + 1;                          // publish after the slot is written
+    return true;
+}
+
+bool queueLine(int32_t mm, uint32_t speed)
+{
+    SEGMENT s;
+
+    s.type = SEGMENT_LINE;
+    s.leftScale = s.rightScale = mm < 0 ? -256 : 256;
+    s.counts = distanceToTicks(mm);
+    s.speed = speed;
+    s.holdTicks = 0;
+    return s.counts == 0 || pushSegment(&s);
+}
+
+bool queueTurn(int32_t degrees, uint32_t speed)
+{
+    SEGMENT s;
+
+    s.type = SEGMENT_TURN;
+    s.leftScale = degrees < 0 ? 256 : -256;
+    s.rightScale = -s.leftScale;
+    s.counts = angleToTicks(degrees);
+    s.speed = speed;
+    s.holdTicks = 0;
+    return s.counts == 0 || pushSegment(&s);
+}
+
+// The centre runs radius * angle, the wheels at (radius -/+ track / 2) / radius
+// of the centre speed; the radius is held to at least half the track so the
+// inner wheel never reverses
+bool queueArc(uint32_t radiusMm, int32_t degrees, uint32_t speed)
+{
+    KINEMATICS kin;
+    SEGMENT s;
+    uint32_t half, inner, outer;
+
+    getKinematics(&kin);
+    half = kin.trackUm / 2000;
+    if(radiusMm < half)
+        radiusMm = half;
+    inner = (radiusMm - half) * 256 / radiusMm;
+    outer = (radiusMm + half) * 256 / radiusMm;
+    s.type = SEGMENT_ARC;
+    s.leftScale = degrees < 0 ? outer : inner;
+    s.rightScale = degrees < 0 ? inner : outer;
+    s.counts = distanceToTicks(((uint64_t)radiusMm * abs(degrees) * 355 + 180 * 113 / 2) / (180 * 113));
+    s.speed = speed;
+    s.holdTicks = 0;
+    return s.counts == 0 || pushSegment(&s);
+}
+
+bool queueHold(int32_t leftMmS, int32_t rightMmS, uint32_t ms)
+{
+    SEGMENT s;
+    uint32_t speed = abs(leftMmS) > abs(rightMmS) ? abs(leftMmS) : abs(rightMmS);
+
+    if(speed == 0)
+        speed = 1;
+    s.type = SEGMENT_HOLD;
+    s.leftScale = leftMmS * 256 / (int32_t)speed;
+    s.rightScale = rightMmS * 256 / (int32_t)speed;
+    s.counts = 0;
+    s.speed = speed;
+    s.holdTicks = ms * CONTROL_HZ / 1000;
+    return pushSegment(&s);
+}
+
+uint8_t getSegmentsPending()
+{
+    return (uint8_t)(segmentHead - segmentTail) + (segmentRunning ? 1 : 0);
+}
+
+// True once the queue has run dry and the last segment has finished
+bool isMotionDone()
+{
+    return !clearRequest && !segmentRunning && segmentHead == segmentTail;
+}
+
+// Drop everything queued, called by stop(). The tail belongs to the control
+// ISR, so main only posts the request and the ISR drains the queue on its
+// next tick; segments pushed after this call are kept.
+void clearSegments()
+{
+    clearHead = segmentHead;
+    clearRequest = true;
+}
+
+// Wheels turning the same way in both segments, so speed can carry across
+static bool canBlend(const SEGMENT *from, const SEGMENT *to)
+{
+    return ((from->leftScale < 0) == (to->leftScale < 0)) && ((from->rightScale < 0) == (to->rightScale < 0));
+}
+
+static void startSegment(bool keepSpeed)
+{
+    current = segments[segmentTail & (SEGMENT_QUEUE_SIZE-1)];
+    segmentTail++;
+    holdLeft = current.holdTicks;
+    resetHeading();
+    startProfileScaled(current.leftScale, current.rightScale, current.counts, current.speed, PROFILE_ACCEL, PROFILE_JERK, keepSpeed);
+    segmentRunning = true;
+}
+
+// Called from the control ISR each tick before the profile is stepped.
+// Starts the next segment as soon as the current one reaches its target;
+// while the next one is known, the current one only slows to the speed
+// it can carry into it.
+void updateSegments()
+{
+    const SEGMENT *next;
+    bool finished;
+
+    if(clearRequest)
+    {
+        segmentTail = clearHead;
+        segmentRunning = false;
+        clearRequest = false;
+        return;
+    }
+
+    if(!segmentRunning)
+    {
+        if(segmentHead != segmentTail)
+            startSegment(false);
+        return;
+    }
+
+    if(current.type == SEGMENT_HOLD)
+        finished = holdLeft == 0 || --holdLeft == 0;
+    else
+        finished = isProfileDone();
+
+    next = segmentHead != segmentTail ? &segments[segmentTail & (SEGMENT_QUEUE_SIZE-1)] : 0;
+    if(!finished)
+    {
+        if(current.type != SEGMENT_HOLD)
+            setProfileExitSpeed(next && canBlend(&current, next) ? (next->speed < current.speed ? next->speed : current.speed) : 0);
+        return;
+    }
+
+    if(next)
+        startSegment(canBlend(&current, next));
+    else
+    {
+        segmentRunning = false;
+        finishQueuedMove();
+    }
+}
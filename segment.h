@@ -0,0 +1,58 @@
+// Motion Segment Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// None, consumed by the control loop interrupt (Timer 4A)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef SEGMENT_H_
+#define SEGMENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SEGMENT_QUEUE_SIZE 16                      // power of two
+
+typedef enum _SEGMENT_TYPE
+{
+    SEGMENT_LINE,                                  // straight, negative distance backs up
+    SEGMENT_TURN,                                  // pivot in place, positive is counter-clockwise
+    SEGMENT_ARC,                                   // forward on a radius, positive is to the left
+    SEGMENT_HOLD                                   // fixed wheel speeds for a time
+} SEGMENT_TYPE;
+
+typedef struct _SEGMENT
+{
+    SEGMENT_TYPE type;
+    int16_t leftScale;                             // wheel speed per unit of segment speed (Q8)
+    int16_t rightScale;
+    uint32_t counts;                               // average ticks of both wheels, 0 for a hold
+    uint32_t speed;                                // mm/s
+    uint32_t holdTicks;                            // control ticks, holds only
+} SEGMENT;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+bool queueLine(int32_t mm, uint32_t speed);
+bool queueTurn(int32_t degrees, uint32_t speed);
+bool queueArc(uint32_t radiusMm, int32_t degrees, uint32_t speed);
+bool queueHold(int32_t leftMmS, int32_t rightMmS, uint32_t ms);
+uint8_t getSegmentsPending();
+bool isMotionDone();
+void clearSegments();
+void updateSegments();
+
+#endif
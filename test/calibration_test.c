@@ -0,0 +1,139 @@
+// Motor Calibration Host Test
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host, no hardware
+// Build and run from the repository root:
+//   gcc -std=gnu99 -I. -o cal_test test/calibration_test.c calibration.c && ./cal_test
+
+// Runs the full calibration sweep against a synthetic motor (deadband, a
+// concave speed curve and +/-10 mm/s measurement noise), then checks the
+// stored feed-forward against the inverse of the model
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "calibration.h"
+#include "control.h"
+#include "encoder.h"
+
+#define MAX_ERROR_PWM 20                           // allowed feed-forward error
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint32_t eeprom[512];
+static int32_t duty[ENCODER_COUNT];
+
+//-----------------------------------------------------------------------------
+// Stubs for the target libraries
+//-----------------------------------------------------------------------------
+
+bool initEeprom() { return true; }
+uint32_t readEeprom(uint16_t add) { return eeprom[add]; }
+void writeEeprom(uint16_t add, uint32_t data) { eeprom[add] = data; }
+void waitMicrosecond(uint32_t us) { }
+void wakeMotors() { }
+void stop() { duty[0] = duty[1] = 0; }
+void setOpenLoopPwm(int32_t left, int32_t right) { duty[ENCODER_LEFT] = left; duty[ENCODER_RIGHT] = right; }
+
+// Each curve gets its own deadband and top speed
+static double model(uint8_t curve, double pwm)
+{
+    double dead = 600 + curve * 25;
+    double top = 480 - curve * 20;
+    double x;
+
+    if(pwm <= dead)
+        return 0;
+    x = (pwm - dead) / (1023 - dead);
+    return top * (1 - 0.6 * (1 - x) * (1 - x) - 0.4 * (1 - x));
+}
+
+uint32_t getWheelSpeed(uint8_t wheel)
+{
+    int32_t d = duty[wheel];
+    double v = model(CAL_CURVE(wheel, d < 0), abs(d)) + rand() % 21 - 10;
+
+    return v < 0 ? 0 : v;
+}
+
+// PWM where the model reaches a speed, by bisection
+static double inverse(uint8_t curve, double speed)
+{
+    double lo = 0, hi = 1023, mid;
+    int i;
+
+    for(i = 0; i < 50; i++)
+    {
+        mid = (lo + hi) / 2;
+        if(model(curve, mid) < speed)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return hi;
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main()
+{
+    uint16_t saved[CAL_CURVES][CAL_POINTS];
+    uint8_t c, k;
+    uint32_t s, ff;
+    int worst = 0, error, fail = 0;
+
+    initCalibration();
+    if(!runCalibration())
+    {
+        printf("FAIL: calibration reported a wheel that did not move\n");
+        return 1;
+    }
+
+    for(c = 0; c < CAL_CURVES; c++)
+    {
+        for(k = 1; k < CAL_POINTS; k++)
+            if(getCalibrationPoint(c, k) < getCalibrationPoint(c, k - 1))
+            {
+                printf("FAIL: curve %u not monotone at %u\n", c, k);
+                fail = 1;
+            }
+        for(s = CAL_MOVING_MMS; model(c, 1023) > s + 20; s += 10)
+        {
+            ff = getFeedForward(c / 2, c & 1, s);
+            error = abs((int)ff - (int)(inverse(c, s) + 0.5));
+            if(error > worst)
+                worst = error;
+        }
+    }
+
+    // The tables must survive a reload from EEPROM
+    for(c = 0; c < CAL_CURVES; c++)
+        for(k = 0; k < CAL_POINTS; k++)
+            saved[c][k] = getCalibrationPoint(c, k);
+    initCalibration();
+    for(c = 0; c < CAL_CURVES; c++)
+        for(k = 0; k < CAL_POINTS; k++)
+            if(getCalibrationPoint(c, k) != saved[c][k])
+            {
+                printf("FAIL: curve %u entry %u changed on reload\n", c, k);
+                fail = 1;
+            }
+    printf("worst feed-forward error %d PWM (limit %d)\n", worst, MAX_ERROR_PWM);
+    if(worst > MAX_ERROR_PWM)
+        fail = 1;
+    printf(fail ? "FAIL\n" : "PASS\n");
+    return fail;
+}
@@ -0,0 +1,163 @@
+// Wheel Encoder Host Test
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host, no hardware
+// Build and run from the repository root:
+//   gcc -std=gnu99 -I. -DENCODER_SOFTWARE_COUNT=1 "-D_delay_cycles(x)=" -o encoder_test test/encoder_test.c encoder.c && ./encoder_test
+
+// Replays collector edge streams, with contact bounce after every slot
+// edge, through the software-count edge path: encoderEdge() and
+// getDebounceTicks() on an accepted edge, encoderBounce() for an edge
+// inside the lockout. Checks the counts and the speed estimate, then
+// times the edge path. The collector vector has serviced nothing but the
+// encoder since IR decoding moved to its own capture timer, so the slowest
+// edge path bounds how long one collector edge can hold off the next.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "encoder.h"
+
+#define MM_PER_EDGE ((double)WHEEL_CIRCUMFERENCE_MM / ENCODER_EDGES_PER_REV)
+#define BOUNCE_US 300                              // bounce edges follow a slot edge this far apart
+#define BOUNCES 3                                  // bounce edges per slot edge
+#define EDGES 400                                  // slot edges per run
+#define SPEED_TOLERANCE 0.05
+#define TIMING_RUNS 50
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint32_t now = 1000000;
+static uint32_t lockoutEnd[ENCODER_COUNT];
+static bool bounceLatched[ENCODER_COUNT];
+static uint32_t counted[ENCODER_COUNT];
+static bool ok = true;
+
+// Slowest run of each edge path, fastest over the timing runs
+static uint64_t edgePathNs[EDGES];
+
+//-----------------------------------------------------------------------------
+// Stubs for the target libraries
+//-----------------------------------------------------------------------------
+
+uint32_t getTicks() { return now; }
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void check(const char *name, bool pass)
+{
+    printf("%s: %s\n", pass ? "PASS" : "FAIL", name);
+    ok &= pass;
+}
+
+static uint64_t getNs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// One collector edge at now, as the edge and debounce ISRs see it; returns
+// the host time of the edge ISR body, 0 for an edge inside the lockout
+static uint64_t collectorEdge(uint8_t wheel, uint32_t commandedMmS)
+{
+    uint64_t start;
+
+    if((int32_t)(now - lockoutEnd[wheel]) < 0)
+    {
+        bounceLatched[wheel] = true;             // the debounce ISR finds it latched
+        return 0;
+    }
+    if(bounceLatched[wheel])
+    {
+        encoderBounce(wheel);
+        bounceLatched[wheel] = false;
+    }
+    start = getNs();
+    counted[wheel] += encoderEdge(wheel, now);
+    lockoutEnd[wheel] = now + getDebounceTicks(wheel, commandedMmS);
+    return getNs() - start;
+}
+
+// Drive one wheel at a steady speed with bounce after every slot edge,
+// then check the count and the speed estimate
+static void runWheel(uint8_t wheel, uint32_t mmS, bool timed)
+{
+    uint32_t period = MM_PER_EDGE * TICKS_PER_US * 1000000 / mmS;
+    uint32_t speed, start = counted[wheel];
+    uint64_t ns;
+    uint16_t i;
+    uint8_t b;
+
+    for(i = 0; i < EDGES; i++)
+    {
+        ns = collectorEdge(wheel, mmS);
+        if(timed && ns < edgePathNs[i])
+            edgePathNs[i] = ns;
+        for(b = 1; b <= BOUNCES; b++)
+        {
+            now += BOUNCE_US * TICKS_PER_US;
+            collectorEdge(wheel, mmS);
+        }
+        now += period - BOUNCES * BOUNCE_US * TICKS_PER_US;
+    }
+    now -= period - BOUNCES * BOUNCE_US * TICKS_PER_US;
+    speed = getWheelSpeed(wheel);
+    if(!timed)
+    {
+        printf("%4u mm/s: %u of %u edges counted, %u mm/s measured\n",
+               mmS, counted[wheel] - start, EDGES, speed);
+        check("every slot edge counted, no bounce", counted[wheel] - start == EDGES);
+        check("speed within 5%", speed > mmS * (1 - SPEED_TOLERANCE) && speed < mmS * (1 + SPEED_TOLERANCE));
+    }
+    now += ENCODER_STOPPED_MS * TICKS_PER_MS * 2;    // let the wheel stop before the next run
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(void)
+{
+    const uint32_t speeds[] = {100, 300, 600, 1000};
+    ENCODER_STATS stats;
+    uint64_t worst = 0;
+    uint8_t i, run;
+    uint16_t j;
+
+    initEncoders();
+    for(i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++)
+        runWheel(ENCODER_LEFT, speeds[i], false);
+    getEncoderStats(ENCODER_LEFT, &stats);
+    printf("bounces %u, lost %u, shortest accepted gap %u us, last lockout %u us\n",
+           stats.bounces, stats.lost, stats.minGapUs, stats.windowUs);
+    check("bounces seen and none mistaken for lost edges", stats.bounces > 0 && stats.lost == 0);
+
+    for(j = 0; j < EDGES; j++)
+        edgePathNs[j] = UINT64_MAX;
+    for(run = 0; run < TIMING_RUNS; run++)
+        runWheel(ENCODER_RIGHT, speeds[run % (sizeof(speeds) / sizeof(speeds[0]))], true);
+    for(j = 0; j < EDGES; j++)
+        if(edgePathNs[j] > worst)
+            worst = edgePathNs[j];
+    printf("collector edge path on this host: worst %llu ns (timing overhead included)\n",
+           (unsigned long long)worst);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,399 @@
+// IR Decoder Host Test
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host, no hardware
+// Build and run from the repository root:
+//   gcc -std=gnu99 -I. "-D_delay_cycles(x)=" -o ir_test test/ir_test.c ir.c && ./ir_test
+
+// Replays synthetic NEC, RC5 and Sony SIRC pulse trains through irEdge()
+// with random per-edge jitter and reports the decode rate per protocol.
+// Any frame that decodes wrong, or decodes as another protocol, is a
+// failure. Also checks held buttons (NEC repeat frames, RC5 and SIRC
+// frames resent within the repeat window) and NEC inverse-byte rejection.
+// Finally the same NEC edge stream is timed through irEdge() and through
+// a copy of the floating-point decoder it replaced, and both costs are
+// reported. The host has a double-precision FPU and the target does not,
+// so the ratio here understates the gain on the robot.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "ir.h"
+
+#define FRAMES 200                                 // random frames per protocol and jitter step
+#define JITTER_PASS_US 100                         // every frame must decode up to this jitter
+#define JITTER_MAX_US 200                          // rates are reported up to this jitter
+#define JITTER_STEP_US 50
+#define IDLE_TICKS (100 * 40000)                   // quiet line before each frame
+#define TIMED_FRAMES 2000                          // NEC frames in the timing comparison
+#define NEC_FRAME_EDGES 68                         // idle, leader, 32 bits and the stop mark
+
+// Floating-point decoder this library replaced, from the old Port D ISR
+#define LEGACY_T 22500.0
+#define LEGACY_FRAME_TICKS (80 * 40000)
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint32_t now = 1000000;
+static uint32_t jitter = 0;                        // +/- ticks added to every interval
+static bool ok = true;
+
+// Recorded edge stream for the timing comparison
+static bool recording = false;
+static uint32_t traceLength = 0;
+static uint32_t traceTicks[TIMED_FRAMES * NEC_FRAME_EDGES];
+static bool traceMark[TIMED_FRAMES * NEC_FRAME_EDGES];
+
+// Reference decoder state, as it was in the old ISR
+static uint32_t legacyTime[50];
+static uint8_t legacyCount = 0;
+static uint32_t legacyBase = 0;                    // stands in for resetting the free-running timer
+static uint32_t legacyCode = 0;
+static uint32_t legacyFrames = 0;
+static uint8_t legacyData = 0;
+
+//-----------------------------------------------------------------------------
+// Stubs for the target libraries
+//-----------------------------------------------------------------------------
+
+uint32_t getTicks() { return now; }
+
+//-----------------------------------------------------------------------------
+// Pulse train generators
+//-----------------------------------------------------------------------------
+
+static uint32_t jittered(uint32_t ticks)
+{
+    if(jitter == 0)
+        return ticks;
+    return ticks + rand() % (2 * jitter + 1) - jitter;
+}
+
+// Feed one edge to the decoders, or keep it for the timing comparison
+static void edge(bool mark)
+{
+    if(recording)
+    {
+        traceTicks[traceLength] = now;
+        traceMark[traceLength] = mark;
+        traceLength++;
+    }
+    else
+        irEdge(now, mark);
+}
+
+// A mark (carrier) of the given width ends
+static void mark(uint32_t ticks)
+{
+    now += jittered(ticks);
+    edge(true);
+}
+
+// A space of the given width ends
+static void space(uint32_t ticks)
+{
+    now += jittered(ticks);
+    edge(false);
+}
+
+static void sendNecCode(uint32_t code)
+{
+    uint8_t i;
+
+    space(IDLE_TICKS);
+    mark(16 * NEC_UNIT_TICKS);
+    space(8 * NEC_UNIT_TICKS);
+    for(i = 0; i < NEC_BITS; i++)
+    {
+        mark(NEC_UNIT_TICKS);
+        space((code >> i) & 1 ? 3 * NEC_UNIT_TICKS : NEC_UNIT_TICKS);
+    }
+    mark(NEC_UNIT_TICKS);
+}
+
+static void sendNec(uint8_t address, uint8_t command)
+{
+    sendNecCode(address | (uint32_t)(uint8_t)~address << 8 | (uint32_t)command << 16 | (uint32_t)(uint8_t)~command << 24);
+}
+
+// Sent every 108 ms while the button is held
+static void sendNecRepeat()
+{
+    space(40 * 40000);
+    mark(16 * NEC_UNIT_TICKS);
+    space(4 * NEC_UNIT_TICKS);
+    mark(NEC_UNIT_TICKS);
+}
+
+// Manchester coded, a 1 is space then mark; runs of equal half bits merge
+static void sendRc5(bool toggle, uint8_t address, uint8_t command)
+{
+    uint32_t code = 1 << 13 | (command & 0x40 ? 0 : 1) << 12 | toggle << 11 | (address & 0x1F) << 6 | (command & 0x3F);
+    uint32_t run = IDLE_TICKS;
+    bool level = false, half;
+    uint8_t i;
+
+    for(i = 0; i < 2 * RC5_BITS; i++)
+    {
+        half = ((code >> (RC5_BITS - 1 - i / 2)) & 1) == (i & 1);
+        if(half == level)
+            run += RC5_UNIT_TICKS;
+        else
+        {
+            if(level)
+                mark(run);
+            else
+                space(run);
+            level = half;
+            run = RC5_UNIT_TICKS;
+        }
+    }
+    if(level)
+        mark(run);
+}
+
+// Pulse width coded, LSB first: 7 command bits then 5 address bits
+static void sendSirc(uint8_t address, uint8_t command)
+{
+    uint32_t code = (command & 0x7F) | (address & 0x1F) << 7;
+    uint8_t i;
+
+    space(IDLE_TICKS);
+    mark(4 * SIRC_UNIT_TICKS);
+    for(i = 0; i < SIRC_BITS; i++)
+    {
+        space(SIRC_UNIT_TICKS);
+        mark((code >> i) & 1 ? 2 * SIRC_UNIT_TICKS : SIRC_UNIT_TICKS);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Reference decoder
+//-----------------------------------------------------------------------------
+
+// Falling edges only (start of each mark), logic unchanged from the old ISR
+// apart from the timer reads and the remote() call at the end of a frame
+static void legacyIrEdge(uint32_t ticks)
+{
+    uint32_t tav = ticks - legacyBase;
+    int i;
+
+    if(tav > LEGACY_FRAME_TICKS)
+        legacyCount = 0;
+    if(legacyCount == 0)
+    {
+        legacyBase = ticks;
+        tav = 0;
+    }
+    legacyTime[legacyCount] = tav;
+
+    if(legacyCount == 0)
+        legacyCount++;
+    else if(legacyCount == 1)
+    {
+        uint32_t t = legacyTime[1] - legacyTime[0];
+
+        if((t >= 13*40000) && (t <= 14*40000))
+            legacyCount++;
+        else
+            legacyCount = 0;
+    }
+    else if(legacyCount > 1)
+    {
+        uint32_t data = legacyTime[legacyCount] - legacyTime[legacyCount-1];
+        if((data > 1.5*LEGACY_T && data < 2.5*LEGACY_T) || (data > 3.5*LEGACY_T && data < 4.5*LEGACY_T))
+            legacyCount++;
+        else
+            legacyCount = 0;
+    }
+    if(legacyCount == 34)
+    {
+        legacyCount = 0;
+        for(i = 1; i <= 34; i++)
+        {
+            uint32_t t = legacyTime[i+1] - legacyTime[i];
+
+            if(t > (1.5*LEGACY_T) && t < (2.5*LEGACY_T))
+                legacyCode |= 0 << (i-1);
+            else if(t > (3.5*LEGACY_T) && t < (4.5*LEGACY_T))
+                legacyCode |= 1u << (i-1);
+        }
+        legacyData = legacyCode >> 16;
+        legacyCode = 0;
+        legacyFrames++;
+    }
+}
+
+static uint64_t getNs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void check(const char *name, bool pass)
+{
+    printf("%s: %s\n", pass ? "PASS" : "FAIL", name);
+    ok &= pass;
+}
+
+// True if exactly one event is waiting and it matches
+static bool expect(IR_PROTOCOL protocol, uint8_t address, uint8_t command, bool repeat)
+{
+    IR_EVENT event;
+    bool match;
+
+    if(!getIrEvent(&event))
+        return false;
+    match = event.protocol == protocol && event.address == address && event.command == command
+            && event.repeat == repeat;
+    while(getIrEvent(&event))
+        match = false;
+    return match;
+}
+
+static void drain()
+{
+    IR_EVENT event;
+
+    while(getIrEvent(&event));
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(void)
+{
+    uint32_t necOk, rc5Ok, sircOk, rejected, us, edges, frames, j;
+    uint64_t start, ns, newNs = 0, legacyNs = 0, newWorst, legacyWorst;
+    uint64_t newEdgeNs[NEC_FRAME_EDGES], legacyEdgeNs[NEC_FRAME_EDGES];
+    IR_EVENT event;
+    uint8_t address, command;
+    uint16_t i;
+
+    srand(1);
+    for(us = 0; us <= JITTER_MAX_US; us += JITTER_STEP_US)
+    {
+        jitter = us * 40;
+        necOk = rc5Ok = sircOk = 0;
+        for(i = 0; i < FRAMES; i++)
+        {
+            address = rand();
+            command = rand();
+            sendNec(address, command);
+            necOk += expect(IR_NEC, address, command, false);
+            sendRc5(i & 1, address & 0x1F, command & 0x7F);
+            rc5Ok += expect(IR_RC5, address & 0x1F, command & 0x7F, false);
+            sendSirc(address & 0x1F, command & 0x7F);
+            sircOk += expect(IR_SIRC, address & 0x1F, command & 0x7F, false);
+        }
+        printf("jitter %3u us: NEC %3u/%u RC5 %3u/%u SIRC %3u/%u\n",
+               us, necOk, FRAMES, rc5Ok, FRAMES, sircOk, FRAMES);
+        if(us <= JITTER_PASS_US)
+            ok &= necOk == FRAMES && rc5Ok == FRAMES && sircOk == FRAMES;
+    }
+    check("every frame decodes up to 100 us of jitter", ok);
+
+    jitter = 0;
+    drain();
+    sendNec(0x12, 0x34);
+    check("NEC frame", expect(IR_NEC, 0x12, 0x34, false));
+    sendNecRepeat();
+    check("NEC repeat frame", expect(IR_NEC, 0x12, 0x34, true));
+    sendNecRepeat();
+    check("NEC second repeat frame", expect(IR_NEC, 0x12, 0x34, true));
+
+    rejected = getIrRejected();
+    sendNecCode(0x12 | 0x00 << 8 | 0x34 << 16 | 0xCB << 24);
+    check("NEC bad address inverse rejected", !expect(IR_NEC, 0x12, 0x34, false) && getIrRejected() == rejected + 1);
+
+    sendRc5(false, 3, 5);
+    check("RC5 frame", expect(IR_RC5, 3, 5, false));
+    sendRc5(false, 3, 5);
+    check("RC5 resend is a repeat", expect(IR_RC5, 3, 5, true));
+    sendRc5(true, 3, 5);
+    check("RC5 toggled is a new press", expect(IR_RC5, 3, 5, false));
+
+    sendSirc(1, 2);
+    check("SIRC frame", expect(IR_SIRC, 1, 2, false));
+    now -= IDLE_TICKS - 20 * 40000;                  // resent after a 20 ms gap, as a held remote does
+    sendSirc(1, 2);
+    check("SIRC resend is a repeat", expect(IR_SIRC, 1, 2, true));
+
+    check("no events dropped", getIrDropped() == 0);
+
+    // Same NEC stream through both decoders, one frame at a time. Each edge
+    // is also timed on its own; the fastest run of each edge position is
+    // its cost without host preemption, the slowest position the ISR's
+    // worst case.
+    recording = true;
+    for(i = 0; i < TIMED_FRAMES; i++)
+        sendNec(rand(), i);
+    recording = false;
+    for(j = 0; j < NEC_FRAME_EDGES; j++)
+        newEdgeNs[j] = legacyEdgeNs[j] = UINT64_MAX;
+    frames = 0;
+    for(edges = 0; edges < traceLength; edges += NEC_FRAME_EDGES)
+    {
+        for(j = 0; j < NEC_FRAME_EDGES; j++)
+        {
+            start = getNs();
+            irEdge(traceTicks[edges + j], traceMark[edges + j]);
+            ns = getNs() - start;
+            newNs += ns;
+            if(ns < newEdgeNs[j])
+                newEdgeNs[j] = ns;
+        }
+        while(getIrEvent(&event))
+            frames += event.protocol == IR_NEC && event.command == (uint8_t)(edges / NEC_FRAME_EDGES);
+
+        for(j = 0; j < NEC_FRAME_EDGES; j++)
+        {
+            if(traceMark[edges + j])
+                continue;
+            start = getNs();
+            legacyIrEdge(traceTicks[edges + j]);
+            ns = getNs() - start;
+            legacyNs += ns;
+            if(ns < legacyEdgeNs[j])
+                legacyEdgeNs[j] = ns;
+        }
+    }
+    newWorst = legacyWorst = 0;
+    for(j = 0; j < NEC_FRAME_EDGES; j++)
+    {
+        if(newEdgeNs[j] > newWorst)
+            newWorst = newEdgeNs[j];
+        if(legacyEdgeNs[j] != UINT64_MAX && legacyEdgeNs[j] > legacyWorst)
+            legacyWorst = legacyEdgeNs[j];
+    }
+    printf("NEC stream, %u frames of %u edges (timing overhead included):\n", TIMED_FRAMES, NEC_FRAME_EDGES);
+    printf("  irEdge():    %5.0f ns per frame, worst edge %4llu ns (all three decoders, both edges)\n",
+           (double)newNs / TIMED_FRAMES, (unsigned long long)newWorst);
+    printf("  old decoder: %5.0f ns per frame, worst edge %4llu ns (falling edges only)\n",
+           (double)legacyNs / TIMED_FRAMES, (unsigned long long)legacyWorst);
+    printf("  old / new:   %5.2f per frame, %.2f worst edge\n",
+           (double)legacyNs / newNs, (double)legacyWorst / newWorst);
+    check("both decoders decode every timed frame", frames == TIMED_FRAMES && legacyFrames == TIMED_FRAMES);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// Motion Profile Host Test
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host, no hardware
+// Build and run from the repository root:
+//   gcc -std=gnu99 -I. "-D__asm(x)=" -o profile_test test/profile_test.c profile.c kinematics.c && ./profile_test
+
+// Runs trapezoid and S-curve moves against wheels that follow the setpoint
+// exactly, then checks that each move lands on its count target at creep
+// speed without going over the speed or acceleration limits
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "profile.h"
+#include "control.h"
+#include "encoder.h"
+#include "kinematics.h"
+
+#define V_MAX 300                                  // cruise speed in mm/s
+#define MAX_TICKS (60 * CONTROL_HZ)                // give up on a move after a minute
+#define ACCEL_SLACK 1.05                           // Q8 rounding of the per-tick step
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static double positionUm;
+static int32_t setpoint;
+
+//-----------------------------------------------------------------------------
+// Stubs for the target libraries
+//-----------------------------------------------------------------------------
+
+uint32_t getEncoderCount(uint8_t wheel)
+{
+    KINEMATICS kin;
+
+    getKinematics(&kin);
+    return positionUm * 256 / kin.umPerTickQ8;
+}
+
+void setWheelSpeeds(int32_t left, int32_t right)
+{
+    setpoint = left;
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+static bool runMove(uint32_t mm, uint32_t jerk)
+{
+    uint32_t counts = distanceToTicks(mm);
+    double accel, accelMax = 0;
+    int32_t last = 0, speedMax = 0;
+    uint32_t t;
+    bool ok;
+
+    positionUm = 0;
+    setpoint = 0;
+    startProfile(1, 1, counts, V_MAX, PROFILE_ACCEL, jerk);
+    for(t = 0; t < MAX_TICKS && !isProfileDone(); t++)
+    {
+        updateProfile();
+        accel = (double)abs(setpoint - last) * CONTROL_HZ;
+        if(accel > accelMax)
+            accelMax = accel;
+        if(setpoint > speedMax)
+            speedMax = setpoint;
+        last = setpoint;
+        positionUm += setpoint * 1000.0 / CONTROL_HZ;
+    }
+
+    ok = isProfileDone() && setpoint <= PROFILE_MIN_SPEED * 2 && speedMax <= V_MAX && accelMax <= PROFILE_ACCEL * ACCEL_SLACK;
+    printf("%s: %4u mm jerk %4u, %5.2f s, end %3d mm/s, peak %3d mm/s, %4.0f mm/s^2\n",
+           ok ? "PASS" : "FAIL", mm, jerk, (double)t / CONTROL_HZ, setpoint, speedMax, accelMax);
+    return ok;
+}
+
+int main(void)
+{
+    const uint32_t distances[] = {50, 100, 500, 1000, 3000};
+    const uint32_t jerks[] = {0, PROFILE_JERK};
+    bool ok = true;
+    uint8_t i, j;
+
+    initKinematics();
+    for(j = 0; j < sizeof(jerks) / sizeof(jerks[0]); j++)
+        for(i = 0; i < sizeof(distances) / sizeof(distances[0]); i++)
+            ok &= runMove(distances[i], jerks[j]);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+// Ultrasonic Ranging Host Test
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: Linux host, no hardware
+// Build and run from the repository root:
+//   gcc -std=gnu99 -I. "-D__asm(x)=" "-D_delay_cycles(x)=" -o ranging_test test/ranging_test.c ultrasonic.c filter.c -lm && ./ranging_test
+
+// Drives the hardware independent ranging engine with simulated echo edges
+// and deadlines: a normal echo, a capture counter wrap, a missing echo, and
+// both outcomes of the proximity gate. The fixed-point tick conversion is
+// checked against the speed of sound in floating point over the whole
+// temperature table and echo range, then timed against the double-precision
+// conversion it replaced over the same tick sweep.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "timebase.h"
+#include "ultrasonic.h"
+
+#define CAPTURE_MASK 0x00FFFFFF                    // front echo runs on a 24-bit capture
+#define MAX_ERROR_MM 1.0                           // rounding to whole millimeters
+#define MAX_ERROR_PPM 1000                         // linear interpolation of the sound table
+#define TIMING_STEP 7                              // ticks between timed conversions
+#define TIMING_PASSES 20                           // sweeps of the echo range per conversion
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint32_t now;
+static bool ok = true;
+static volatile uint32_t sink;                     // keeps the timed conversions from being optimised out
+
+//-----------------------------------------------------------------------------
+// Stubs for the target libraries
+//-----------------------------------------------------------------------------
+
+uint32_t getTicks() { return now; }
+uint32_t ticksSince(uint32_t ticks) { return now - ticks; }
+void waitMicrosecond(uint32_t us) { now += us * TICKS_PER_US; }
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void check(const char *name, bool pass)
+{
+    printf("%s: %s\n", pass ? "PASS" : "FAIL", name);
+    ok &= pass;
+}
+
+// Ping the front sensor with an echo of the given width starting at a capture count
+static RANGE_STATE echo(uint32_t rise, uint32_t width, uint32_t *mm)
+{
+    rangingTrigger(RANGE_FRONT, now);
+    rangingEdge(RANGE_FRONT, rise & CAPTURE_MASK, true);
+    now += width;
+    rangingEdge(RANGE_FRONT, (rise + width) & CAPTURE_MASK, false);
+    rangingDeadline(now);
+    return pollRanging(RANGE_FRONT, mm);
+}
+
+// Largest error of the tick conversion against sqrt(1 + T/273.15) scaling
+// of the 0 C speed of sound, from the closest echo to the timeout, as a
+// fraction of the allowed error (above 1 fails)
+static double conversionError(int16_t celsius)
+{
+    double speed = 331300.0 * sqrt(1 + celsius / 273.15);
+    double mm, error, worst = 0;
+    uint32_t ticks;
+
+    setRangingTemperature(celsius);
+    for(ticks = 0; ticks <= RANGE_TIMEOUT_US * TICKS_PER_US; ticks += 997)
+    {
+        mm = speed * ticks / (2.0 * TICKS_PER_US * 1000000);
+        error = fabs(rangeTicksToMm(ticks) - mm) / (MAX_ERROR_MM + mm * MAX_ERROR_PPM / 1e6);
+        if(error > worst)
+            worst = error;
+    }
+    return worst;
+}
+
+// Conversion this library replaced, fixed at 340 m/s
+static uint32_t legacyTicksToMm(uint32_t ticks)
+{
+    return (ticks * 0.34 * 0.025) / 2;
+}
+
+static uint64_t getNs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Host time of one sweep of the echo range through a conversion, per call
+static double timeConversion(uint32_t (*convert)(uint32_t))
+{
+    uint64_t start = getNs();
+    uint32_t sum = 0, calls = 0, ticks;
+    uint8_t pass;
+
+    for(pass = 0; pass < TIMING_PASSES; pass++)
+        for(ticks = 0; ticks <= RANGE_TIMEOUT_US * TICKS_PER_US; ticks += TIMING_STEP)
+        {
+            sum += convert(ticks);
+            calls++;
+        }
+    sink = sum;
+    return (double)(getNs() - start) / calls;
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(void)
+{
+    uint32_t mm = 0;
+    RANGE_STATE state;
+    double error, worst = 0, fixedNs, legacyNs;
+    int16_t celsius;
+
+    resetRangingEngine();
+
+    state = echo(1000, rangeMmToTicks(1000), &mm);
+    check("echo of 1000 mm", state == RANGE_DONE && mm >= 999 && mm <= 1001);
+
+    state = echo(CAPTURE_MASK - 100, rangeMmToTicks(500), &mm);
+    check("echo across the capture wrap", state == RANGE_DONE && mm >= 499 && mm <= 501);
+
+    rangingEdge(RANGE_FRONT, 0, true);
+    rangingEdge(RANGE_FRONT, rangeMmToTicks(200), false);
+    check("edges while idle are ignored", pollRanging(RANGE_FRONT, &mm) == RANGE_IDLE);
+
+    rangingTrigger(RANGE_FRONT, now);
+    rangingDeadline(now + RANGE_TIMEOUT_US * TICKS_PER_US - 1);
+    check("busy before the timeout", pollRanging(RANGE_FRONT, &mm) == RANGE_BUSY);
+    rangingDeadline(now + RANGE_TIMEOUT_US * TICKS_PER_US);
+    state = pollRanging(RANGE_FRONT, &mm);
+    check("no echo times out", state == RANGE_TIMEOUT && mm == RANGE_MAX_MM);
+
+    setProximityGate(RANGE_FRONT, 300);
+    state = echo(5000, rangeMmToTicks(200), &mm);
+    check("echo inside the gate", state == RANGE_DONE && mm >= 199 && mm <= 201
+                                  && getProximity(RANGE_FRONT) == PROXIMITY_HIT);
+
+    rangingTrigger(RANGE_FRONT, now);
+    rangingEdge(RANGE_FRONT, 5000, true);
+    rangingDeadline(now + rangeMmToTicks(300) - 1);
+    check("gated ping busy before the gate", pollRanging(RANGE_FRONT, &mm) == RANGE_BUSY);
+    rangingDeadline(now + rangeMmToTicks(300));
+    state = pollRanging(RANGE_FRONT, &mm);
+    check("gated ping resolves clear at the gate", state == RANGE_CLEAR && getProximity(RANGE_FRONT) == PROXIMITY_CLEAR);
+
+    for(celsius = -20; celsius <= 50; celsius += 5)
+    {
+        error = conversionError(celsius);
+        if(error > worst)
+            worst = error;
+    }
+    printf("worst conversion error %.0f%% of the allowance\n", worst * 100);
+    check("tick conversion from -20 to 50 C", worst <= 1);
+    setRangingTemperature(RANGE_DEFAULT_CELSIUS);
+    check("mm to ticks round trip", rangeTicksToMm(rangeMmToTicks(1234)) == 1234);
+
+    legacyNs = timeConversion(legacyTicksToMm);
+    fixedNs = timeConversion(rangeTicksToMm);
+    printf("tick conversion on this host: fixed point %.2f ns, double %.2f ns, ratio %.2f\n",
+           fixedNs, legacyNs, legacyNs / fixedNs);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+// Timebase Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Wide Timer 5A: free-running 32-bit up counter at the system clock
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+#include "timebase.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Initialize a free-running counter used to timestamp events (wraps every 107 s)
+void initTimebase()
+{
+    SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R5;
+    _delay_cycles(3);
+
+    WTIMER5_CTL_R &= ~TIMER_CTL_TAEN;                // turn-off timer before reconfiguring
+    WTIMER5_CFG_R = 4;                               // configure as 32-bit timer (A only)
+    WTIMER5_TAMR_R = TIMER_TAMR_TAMR_PERIOD | TIMER_TAMR_TACDIR; // periodic mode, count up
+    WTIMER5_TAILR_R = 0xFFFFFFFF;                    // full 32-bit range
+    WTIMER5_IMR_R = 0;                               // no interrupts
+    WTIMER5_CTL_R |= TIMER_CTL_TAEN;                 // turn-on timer
+}
+
+// Current time in system clock ticks
+uint32_t getTicks()
+{
+    return WTIMER5_TAV_R;
+}
+
+// Elapsed ticks since an earlier timestamp, correct across one wrap
+uint32_t ticksSince(uint32_t ticks)
+{
+    return WTIMER5_TAV_R - ticks;
+}
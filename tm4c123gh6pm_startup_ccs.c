@@ -59,6 +59,14 @@ extern void RightFallingEdgeIsr(void);
 extern void LeftFallingEdgeIsr(void);
 extern void LeftDebounceIsr(void);
 extern void RightDebounceIsr(void);
+extern void RangingServiceIsr(void);
+extern void FrontEchoIsr(void);
+extern void RightEchoIsr(void);
+extern void BackEchoIsr(void);
+extern void LeftEchoIsr(void);
+extern void RangeDeadlineIsr(void);
+extern void IrCaptureIsr(void);
+extern void ControlIsr(void);
 //*****************************************************************************
 //
 // The vector table.  Note that the proper constructs must be placed on this to
@@ -105,7 +113,7 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // ADC Sequence 2
     IntDefaultHandler,                      // ADC Sequence 3
     IntDefaultHandler,                      // Watchdog timer
-    IntDefaultHandler,                      // Timer 0 subtimer A
+    RangingServiceIsr,                      // Timer 0 subtimer A
     IntDefaultHandler,                      // Timer 0 subtimer B
     LeftDebounceIsr,                       // Timer 1 subtimer A
     IntDefaultHandler,                      // Timer 1 subtimer B
@@ -121,8 +129,8 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // GPIO Port H
     IntDefaultHandler,                      // UART2 Rx and Tx
     IntDefaultHandler,                      // SSI1 Rx and Tx
-    IntDefaultHandler,                      // Timer 3 subtimer A
-    IntDefaultHandler,                      // Timer 3 subtimer B
+    FrontEchoIsr,                           // Timer 3 subtimer A
+    RightEchoIsr,                           // Timer 3 subtimer B
     IntDefaultHandler,                      // I2C1 Master and Slave
     IntDefaultHandler,                      // Quadrature Encoder 1
     IntDefaultHandler,                      // CAN0
@@ -156,7 +164,7 @@ void (* const g_pfnVectors[])(void) =
     0,                                      // Reserved
     IntDefaultHandler,                      // I2C2 Master and Slave
     IntDefaultHandler,                      // I2C3 Master and Slave
-    IntDefaultHandler,                      // Timer 4 subtimer A
+    ControlIsr,                             // Timer 4 subtimer A
     IntDefaultHandler,                      // Timer 4 subtimer B
     0,                                      // Reserved
     0,                                      // Reserved
@@ -178,7 +186,7 @@ void (* const g_pfnVectors[])(void) =
     0,                                      // Reserved
     0,                                      // Reserved
     0,                                      // Reserved
-    IntDefaultHandler,                      // Timer 5 subtimer A
+    RangeDeadlineIsr,                       // Timer 5 subtimer A
     IntDefaultHandler,                      // Timer 5 subtimer B
     IntDefaultHandler,                      // Wide Timer 0 subtimer A
     IntDefaultHandler,                      // Wide Timer 0 subtimer B
@@ -186,10 +194,10 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // Wide Timer 1 subtimer B
     IntDefaultHandler,                      // Wide Timer 2 subtimer A
     IntDefaultHandler,                      // Wide Timer 2 subtimer B
-    IntDefaultHandler,                      // Wide Timer 3 subtimer A
+    IrCaptureIsr,                           // Wide Timer 3 subtimer A
     IntDefaultHandler,                      // Wide Timer 3 subtimer B
-    IntDefaultHandler,                      // Wide Timer 4 subtimer A
-    IntDefaultHandler,                      // Wide Timer 4 subtimer B
+    BackEchoIsr,                            // Wide Timer 4 subtimer A
+    LeftEchoIsr,                            // Wide Timer 4 subtimer B
     IntDefaultHandler,                      // Wide Timer 5 subtimer A
     IntDefaultHandler,                      // Wide Timer 5 subtimer B
     IntDefaultHandler,                      // FPU
@@ -24,8 +24,13 @@
 #include "uart0.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
 #include "movement.h"
 #include "navigate.h"
+#include "ultrasonic.h"
+#include "keymap.h"
+#include "encoder.h"
+#include "calibration.h"
 
 // PortA masks
 #define UART_TX_MASK 2
@@ -166,6 +171,13 @@ void parseFields(USER_DATA *data)
                     data->fieldCount += 1;
                 }
             }
+            else if((data->buffer[i]=='-')&&(data->buffer[i-1]=='\0')&&(data->buffer[i+1]>=48)&&(data->buffer[i+1]<=57))
+            {
+                // a leading minus sign belongs to the number
+                data->fieldPosition[data->fieldCount] = i;
+                data->fieldType[data->fieldCount] = 'n';
+                data->fieldCount += 1;
+            }
             else
             {
                 data->buffer[i] = '\0';
@@ -179,7 +191,7 @@ void parseFields(USER_DATA *data)
                 data->fieldType[data->fieldCount] = 'a';
                 data->fieldCount += 1;
             }
-            else if((data->buffer[i]>=48)&&(data->buffer[i]<=57))
+            else if(((data->buffer[i]>=48)&&(data->buffer[i]<=57))||((data->buffer[i]=='-')&&(data->buffer[i+1]>=48)&&(data->buffer[i+1]<=57)))
             {
                 data->fieldPosition[data->fieldCount] = i;
                 data->fieldType[data->fieldCount] = 'n';
@@ -242,68 +254,68 @@ void uartcmd(USER_DATA * data)
     {
         if(isCommand(data, "forward", 3))
         {
-            temp = speedToPWMLoad(getFieldInteger(data, 1));
+            temp = getFieldInteger(data, 1);        // mm/s
             forward(temp,getFieldInteger(data, 2));
         }
         else if(isCommand(data, "forward", 2))
         {
-            temp = speedToPWMLoad(getFieldInteger(data, 1));
+            temp = getFieldInteger(data, 1);        // mm/s
             forward(temp,0);
         }
         else
         {
-            forward(1023, 0);
+            forward(CRUISE_SPEED, 0);
         }
     }
     else if(isCommand(data, "reverse", 1))
     {
         if(isCommand(data, "reverse", 3))
         {
-            temp = speedToPWMLoad(getFieldInteger(data, 1));
+            temp = getFieldInteger(data, 1);        // mm/s
             reverse(temp,getFieldInteger(data, 2));
         }
         else if(isCommand(data, "reverse", 2))
         {
-            temp = speedToPWMLoad(getFieldInteger(data, 1));
+            temp = getFieldInteger(data, 1);        // mm/s
             reverse(temp,0);
         }
         else
         {
-            reverse(1023,0);
+            reverse(CRUISE_SPEED, 0);
         }
     }
     else if(isCommand(data, "ccw", 1))
     {
         if(isCommand(data, "ccw", 3))
         {
-            temp = speedToPWMLoad(getFieldInteger(data, 1));
+            temp = getFieldInteger(data, 1);        // mm/s
             ccw(temp,getFieldInteger(data, 2));
         }
         else if(isCommand(data, "ccw", 2))
         {
-            temp = speedToPWMLoad(getFieldInteger(data, 1));
+            temp = getFieldInteger(data, 1);        // mm/s
             ccw(temp,0);
         }
         else
         {
-            ccw(1023,0);
+            ccw(CRUISE_SPEED, 0);
         }
     }
     else if(isCommand(data, "cw", 1))
     {
         if(isCommand(data, "cw", 3))
         {
-            temp = speedToPWMLoad(getFieldInteger(data, 1));
+            temp = getFieldInteger(data, 1);        // mm/s
             cw(temp,getFieldInteger(data, 2));
         }
         else if(isCommand(data, "cw", 2))
         {
-            temp = speedToPWMLoad(getFieldInteger(data, 1));
+            temp = getFieldInteger(data, 1);        // mm/s
             cw(temp,0);
         }
         else
         {
-            cw(1023,0);
+            cw(CRUISE_SPEED, 0);
         }
     }
     else if(isCommand(data, "stop", 1))
@@ -312,7 +324,119 @@ void uartcmd(USER_DATA * data)
     }
     else if(isCommand(data, "navigate", 1))
     {
-        DATA = 16;
+        navigate();
+    }
+    else if(isCommand(data, "distance", 1))
+    {
+        RANGE_SAMPLE scan[RANGE_SENSOR_COUNT];
+        char str[64];
+        uint8_t i;
+
+        getRangeScan(scan);
+        for(i = 0; i < RANGE_SENSOR_COUNT; i++)
+        {
+            if(scan[i].valid)
+                snprintf(str, sizeof(str), "%u: %lu mm (filtered %lu), %lu ms old\n", i, (unsigned long)scan[i].mm, (unsigned long)scan[i].filtered, (unsigned long)(getRangeAgeUs(&scan[i]) / 1000));
+            else
+                snprintf(str, sizeof(str), "%u: No echo, %lu ms old\n", i, (unsigned long)(getRangeAgeUs(&scan[i]) / 1000));
+            putsUart0(str);
+        }
+    }
+    else if(isCommand(data, "temperature", 2))
+    {
+        setRangingTemperature(getFieldInteger(data, 1));
+    }
+    else if(isCommand(data, "learn", 2))
+    {
+        if(startLearning(getFieldString(data, 1)))
+            putsUart0("Press a remote button\n");
+        else
+            putsUart0("Error: Unknown action!\n");
+    }
+    else if(isCommand(data, "keymap", 1))
+    {
+        static const char *protocolNames[IR_PROTOCOL_COUNT] = { "nec", "rc5", "sirc" };
+        KEYMAP_ENTRY entry;
+        char str[48];
+        uint16_t i;
+
+        if(isCommand(data, "keymap", 2) && strcmp(getFieldString(data, 1), "reset") == 0)
+            resetKeymap();
+        for(i = 0; i < KEYMAP_SIZE; i++)
+        {
+            getKeymapEntry(i, &entry);
+            if(entry.action == ACTION_NONE)
+                continue;
+            if(entry.flags & KEYMAP_ANY_ADDRESS)
+                snprintf(str, sizeof(str), "%s any/%u: %s\n", protocolNames[entry.protocol], i, getActionName((REMOTE_ACTION)entry.action));
+            else
+                snprintf(str, sizeof(str), "%s %u/%u: %s\n", protocolNames[entry.protocol], entry.address, i, getActionName((REMOTE_ACTION)entry.action));
+            putsUart0(str);
+        }
+    }
+    else if(isCommand(data, "encoders", 1))
+    {
+        ENCODER_STATS stats;
+        char str[80];
+        uint8_t i;
+
+        for(i = 0; i < ENCODER_COUNT; i++)
+        {
+            getEncoderStats(i, &stats);
+            snprintf(str, sizeof(str), "%s: %lu edges, %lu bounces, %lu lost, window %lu us, min gap %lu us\n",
+                     i == ENCODER_LEFT ? "left" : "right", (unsigned long)getEncoderCount(i),
+                     (unsigned long)stats.bounces, (unsigned long)stats.lost,
+                     (unsigned long)stats.windowUs, (unsigned long)stats.minGapUs);
+            putsUart0(str);
+        }
+        if(isCommand(data, "encoders", 2) && strcmp(getFieldString(data, 1), "reset") == 0)
+            resetEncoderStats();
+    }
+    else if(isCommand(data, "stopmode", 2))
+    {
+        static const char *modeNames[] = { "coast", "brake", "reverse" };
+        uint32_t hold = isCommand(data, "stopmode", 3) ? getFieldInteger(data, 2) : STOP_HOLD_MS;
+        uint8_t i;
+
+        for(i = 0; i < 3 && strcmp(getFieldString(data, 1), modeNames[i]) != 0; i++);
+        if(i < 3)
+            setStopMode((STOP_MODE)i, hold);
+        else
+            putsUart0("Error: Unknown stop mode!\n");
+    }
+    else if(isCommand(data, "overshoot", 1))
+    {
+        char str[40];
+
+        snprintf(str, sizeof(str), "overshoot: left %ld, right %ld ticks\n",
+                 (long)getOvershoot(ENCODER_LEFT), (long)getOvershoot(ENCODER_RIGHT));
+        putsUart0(str);
+    }
+    else if(isCommand(data, "calibrate", 1))
+    {
+        putsUart0("Calibrating, the robot will spin in place\n");
+        if(!runCalibration())
+            putsUart0("Error: Wheel did not move, tables unchanged!\n");
+    }
+    else if(isCommand(data, "calibration", 1))
+    {
+        static const char *curveNames[CAL_CURVES] = { "left fwd", "left rev", "right fwd", "right rev" };
+        char str[16];
+        uint8_t c, k;
+
+        if(isCommand(data, "calibration", 2) && strcmp(getFieldString(data, 1), "reset") == 0)
+            resetCalibration();
+        for(c = 0; c < CAL_CURVES; c++)
+        {
+            putsUart0((char*)curveNames[c]);
+            putsUart0(":");
+            for(k = 0; k < CAL_POINTS; k++)
+            {
+                snprintf(str, sizeof(str), " %u", getCalibrationPoint(c, k));
+                putsUart0(str);
+            }
+            putsUart0("\n");
+        }
     }
     else
     {
@@ -0,0 +1,638 @@
+// Ultrasonic Ranging Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Front sensor: Trigger on (PB6), Echo on T3CCP0 (PB2)
+// Right sensor: Trigger on (PB7), Echo on T3CCP1 (PB3)
+// Back sensor:  Trigger on (PB4), Echo on WT4CCP0 (PD4)
+// Left sensor:  Trigger on (PB5), Echo on WT4CCP1 (PD5)
+// Timer 3A/3B, Wide Timer 4A/4B: edge-time capture of the echo pulses
+// Timer 5A: one-shot deadline for echo timeouts
+// Timer 0A: one-shot ping scheduler for the ranging service
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "wait.h"
+#include "timebase.h"
+#include "filter.h"
+#include "ultrasonic.h"
+
+// PortB masks
+#define FRONT_ECHO_MASK 4
+#define RIGHT_ECHO_MASK 8
+#define BACK_TRIG_MASK 16
+#define LEFT_TRIG_MASK 32
+#define FRONT_TRIG_MASK 64
+#define RIGHT_TRIG_MASK 128
+// PortD masks
+#define BACK_ECHO_MASK 16
+#define LEFT_ECHO_MASK 32
+// BitBand Aliases
+#define PORTB_PIN(n) ((volatile uint32_t *)(0x42000000 + (0x400053FC-0x40000000)*32 + (n)*4))
+#define PORTD_PIN(n) ((volatile uint32_t *)(0x42000000 + (0x400073FC-0x40000000)*32 + (n)*4))
+
+// Timer 3 counts up through a 16-bit load and 8-bit prescaler extension,
+// the wide timer halves are full 32-bit counters
+#define TIMER_CAPTURE_MASK 0x00FFFFFF
+#define WTIMER_CAPTURE_MASK 0xFFFFFFFF
+
+#define TRIGGER_US 10
+
+// Speed of sound in dry air (mm/s), interpolated between entries
+#define SOUND_TABLE_SIZE 8
+static const int16_t soundCelsius[SOUND_TABLE_SIZE] = { -20, -10, 0, 10, 20, 30, 40, 50 };
+static const uint32_t soundSpeed[SOUND_TABLE_SIZE] =  { 319100, 325200, 331300, 337300, 343200, 349000, 354700, 360300 };
+
+typedef struct _RANGE_SENSOR
+{
+    volatile uint32_t *trigger;                    // trigger output
+    volatile uint32_t *echo;                       // echo input level
+    volatile uint32_t *capture;                    // timer register latching the edge time
+    uint32_t captureMask;                          // width of the capture counter
+    uint8_t group;                                 // sensors sharing a group ping together
+} RANGE_SENSOR;
+
+// Sensors in clockwise order; opposite sensors cannot hear each other so
+// they share a group, adjacent ones are pinged in different groups
+static const RANGE_SENSOR rangeSensors[4] =
+{
+    { PORTB_PIN(6), PORTB_PIN(2), &TIMER3_TAR_R,  TIMER_CAPTURE_MASK,  0 },
+    { PORTB_PIN(7), PORTB_PIN(3), &TIMER3_TBR_R,  TIMER_CAPTURE_MASK,  1 },
+    { PORTB_PIN(4), PORTD_PIN(4), &WTIMER4_TAR_R, WTIMER_CAPTURE_MASK, 0 },
+    { PORTB_PIN(5), PORTD_PIN(5), &WTIMER4_TBR_R, WTIMER_CAPTURE_MASK, 1 },
+};
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static volatile RANGE_STATE rangeState[RANGE_SENSOR_COUNT];
+static volatile bool riseSeen[RANGE_SENSOR_COUNT];
+static volatile uint32_t riseTime[RANGE_SENSOR_COUNT];
+static volatile uint32_t rangeDeadline[RANGE_SENSOR_COUNT];
+static volatile uint32_t rangeResult[RANGE_SENSOR_COUNT];
+static volatile uint32_t gateTicks[RANGE_SENSOR_COUNT];      // proximity gate for new pings, 0 if off
+static volatile uint32_t pingGate[RANGE_SENSOR_COUNT];       // gate of the ping in flight
+static volatile PROXIMITY_STATE proximity[RANGE_SENSOR_COUNT];
+static RANGE_CALLBACK rangeCallback = 0;
+static volatile uint32_t rangeScale = RANGE_SCALE_Q32(343200);
+
+// Scan array, each entry published with a sequence counter (odd while being written)
+static volatile uint32_t rangeSeq[RANGE_SENSOR_COUNT];
+static volatile RANGE_SAMPLE rangeLatest[RANGE_SENSOR_COUNT];
+
+// Filter pipeline applied to every published sample
+static HAMPEL_FILTER rangeGate[RANGE_SENSOR_COUNT];
+static EMA_FILTER rangeSmooth[RANGE_SENSOR_COUNT];
+
+// Group scheduler
+static volatile bool serviceRunning = false;
+static uint32_t servicePeriod = 0;
+static uint32_t slotStart = 0;
+static uint8_t groupCount = 1;
+static uint8_t currentGroup = 0;
+static volatile uint8_t groupPending = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Initialize trigger outputs, echo captures and the timeout deadline timer
+void initRanging()
+{
+    uint8_t i;
+
+    // Enable clocks
+    SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R1 | SYSCTL_RCGCGPIO_R3;
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R3 | SYSCTL_RCGCTIMER_R5;
+    SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R4;
+    _delay_cycles(3);
+
+    // Front sensor, always fitted
+    GPIO_PORTB_DIR_R |= FRONT_TRIG_MASK;
+    GPIO_PORTB_DIR_R &= ~FRONT_ECHO_MASK;
+    GPIO_PORTB_DEN_R |= FRONT_TRIG_MASK | FRONT_ECHO_MASK;
+    GPIO_PORTB_AFSEL_R |= FRONT_ECHO_MASK;
+    GPIO_PORTB_PCTL_R &= ~GPIO_PCTL_PB2_M;
+    GPIO_PORTB_PCTL_R |= GPIO_PCTL_PB2_T3CCP0;
+
+    TIMER3_CTL_R &= ~(TIMER_CTL_TAEN | TIMER_CTL_TBEN); // turn-off timer before reconfiguring
+    TIMER3_CFG_R = TIMER_CFG_16_BIT;                 // configure as two 16-bit timers
+    TIMER3_TAMR_R = TIMER_TAMR_TAMR_CAP | TIMER_TAMR_TACMR | TIMER_TAMR_TACDIR;
+                                                     // edge-time capture, count up
+    TIMER3_CTL_R = TIMER_CTL_TAEVENT_BOTH;           // capture rising and falling edges
+    TIMER3_TAILR_R = 0xFFFF;                         // 16-bit count
+    TIMER3_TAPR_R = 0xFF;                            // extended to 24 bits (419 ms wrap)
+    TIMER3_ICR_R = TIMER_ICR_CAECINT;
+    TIMER3_IMR_R = TIMER_IMR_CAEIM;
+    NVIC_EN1_R = 1 << (INT_TIMER3A-16-32);           // turn-on interrupt 51 (TIMER3A)
+    TIMER3_CTL_R |= TIMER_CTL_TAEN;
+
+    if(RANGE_SENSOR_COUNT > RANGE_RIGHT)
+    {
+        GPIO_PORTB_DIR_R |= RIGHT_TRIG_MASK;
+        GPIO_PORTB_DIR_R &= ~RIGHT_ECHO_MASK;
+        GPIO_PORTB_DEN_R |= RIGHT_TRIG_MASK | RIGHT_ECHO_MASK;
+        GPIO_PORTB_AFSEL_R |= RIGHT_ECHO_MASK;
+        GPIO_PORTB_PCTL_R &= ~GPIO_PCTL_PB3_M;
+        GPIO_PORTB_PCTL_R |= GPIO_PCTL_PB3_T3CCP1;
+
+        TIMER3_TBMR_R = TIMER_TBMR_TBMR_CAP | TIMER_TBMR_TBCMR | TIMER_TBMR_TBCDIR;
+        TIMER3_CTL_R |= TIMER_CTL_TBEVENT_BOTH;
+        TIMER3_TBILR_R = 0xFFFF;
+        TIMER3_TBPR_R = 0xFF;
+        TIMER3_ICR_R = TIMER_ICR_CBECINT;
+        TIMER3_IMR_R |= TIMER_IMR_CBEIM;
+        NVIC_EN1_R = 1 << (INT_TIMER3B-16-32);       // turn-on interrupt 52 (TIMER3B)
+        TIMER3_CTL_R |= TIMER_CTL_TBEN;
+    }
+
+    if(RANGE_SENSOR_COUNT > RANGE_BACK)
+    {
+        GPIO_PORTB_DIR_R |= BACK_TRIG_MASK;
+        GPIO_PORTB_DEN_R |= BACK_TRIG_MASK;
+        GPIO_PORTD_DIR_R &= ~BACK_ECHO_MASK;
+        GPIO_PORTD_DEN_R |= BACK_ECHO_MASK;
+        GPIO_PORTD_AFSEL_R |= BACK_ECHO_MASK;
+        GPIO_PORTD_PCTL_R &= ~GPIO_PCTL_PD4_M;
+        GPIO_PORTD_PCTL_R |= GPIO_PCTL_PD4_WT4CCP0;
+
+        WTIMER4_CTL_R &= ~(TIMER_CTL_TAEN | TIMER_CTL_TBEN);
+        WTIMER4_CFG_R = 4;                           // configure as two 32-bit timers
+        WTIMER4_TAMR_R = TIMER_TAMR_TAMR_CAP | TIMER_TAMR_TACMR | TIMER_TAMR_TACDIR;
+        WTIMER4_CTL_R = TIMER_CTL_TAEVENT_BOTH;
+        WTIMER4_TAILR_R = 0xFFFFFFFF;
+        WTIMER4_ICR_R = TIMER_ICR_CAECINT;
+        WTIMER4_IMR_R = TIMER_IMR_CAEIM;
+        NVIC_EN3_R = 1 << (INT_WTIMER4A-16-96);      // turn-on interrupt 118 (WTIMER4A)
+        WTIMER4_CTL_R |= TIMER_CTL_TAEN;
+    }
+
+    if(RANGE_SENSOR_COUNT > RANGE_LEFT)
+    {
+        GPIO_PORTB_DIR_R |= LEFT_TRIG_MASK;
+        GPIO_PORTB_DEN_R |= LEFT_TRIG_MASK;
+        GPIO_PORTD_DIR_R &= ~LEFT_ECHO_MASK;
+        GPIO_PORTD_DEN_R |= LEFT_ECHO_MASK;
+        GPIO_PORTD_AFSEL_R |= LEFT_ECHO_MASK;
+        GPIO_PORTD_PCTL_R &= ~GPIO_PCTL_PD5_M;
+        GPIO_PORTD_PCTL_R |= GPIO_PCTL_PD5_WT4CCP1;
+
+        WTIMER4_TBMR_R = TIMER_TBMR_TBMR_CAP | TIMER_TBMR_TBCMR | TIMER_TBMR_TBCDIR;
+        WTIMER4_CTL_R |= TIMER_CTL_TBEVENT_BOTH;
+        WTIMER4_TBILR_R = 0xFFFFFFFF;
+        WTIMER4_ICR_R = TIMER_ICR_CBECINT;
+        WTIMER4_IMR_R |= TIMER_IMR_CBEIM;
+        NVIC_EN3_R = 1 << (INT_WTIMER4B-16-96);      // turn-on interrupt 119 (WTIMER4B)
+        WTIMER4_CTL_R |= TIMER_CTL_TBEN;
+    }
+
+    // Timer 5A: one-shot deadline, reloaded for the earliest pending timeout
+    TIMER5_CTL_R &= ~TIMER_CTL_TAEN;
+    TIMER5_CFG_R = TIMER_CFG_32_BIT_TIMER;
+    TIMER5_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;
+    TIMER5_ICR_R = TIMER_ICR_TATOCINT;
+    TIMER5_IMR_R = TIMER_IMR_TATOIM;
+    NVIC_EN2_R = 1 << (INT_TIMER5A-16-64);           // turn-on interrupt 108 (TIMER5A)
+
+    groupCount = 1;
+    for(i = 0; i < RANGE_SENSOR_COUNT; i++)
+    {
+        *rangeSensors[i].trigger = 0;
+        if(rangeSensors[i].group >= groupCount)
+            groupCount = rangeSensors[i].group + 1;
+    }
+
+    resetRangingEngine();
+}
+
+// Idle every sensor and restart the filters, touches no hardware
+void resetRangingEngine()
+{
+    uint8_t i;
+
+    for(i = 0; i < RANGE_SENSOR_COUNT; i++)
+    {
+        rangeState[i] = RANGE_IDLE;
+        gateTicks[i] = 0;
+        proximity[i] = PROXIMITY_UNKNOWN;
+        initHampelFilter(&rangeGate[i], RANGE_FILTER_WINDOW, RANGE_FILTER_GAIN_Q4, RANGE_FILTER_FLOOR_MM);
+        initEmaFilter(&rangeSmooth[i], RANGE_SMOOTH_SHIFT);
+    }
+
+    setRangingTemperature(RANGE_DEFAULT_CELSIUS);
+}
+
+// Convert echo pulse width in 40 MHz ticks to millimeters (one UMULL, no floating point)
+uint32_t rangeTicksToMm(uint32_t ticks)
+{
+    return ((uint64_t)ticks * rangeScale + 0x80000000) >> 32;
+}
+
+// Echo pulse width in 40 MHz ticks for a distance in millimeters
+uint32_t rangeMmToTicks(uint32_t mm)
+{
+    return ((uint64_t)mm << 32) / rangeScale;
+}
+
+// Recompute the tick scale for the given air temperature
+void setRangingTemperature(int16_t celsius)
+{
+    uint8_t i = 1;
+    int32_t speed;
+
+    if(celsius < soundCelsius[0])
+        celsius = soundCelsius[0];
+    if(celsius > soundCelsius[SOUND_TABLE_SIZE-1])
+        celsius = soundCelsius[SOUND_TABLE_SIZE-1];
+    while(i < SOUND_TABLE_SIZE-1 && celsius > soundCelsius[i])
+        i++;
+
+    speed = soundSpeed[i-1] + ((int32_t)(soundSpeed[i] - soundSpeed[i-1]) * (celsius - soundCelsius[i-1]))
+                              / (soundCelsius[i] - soundCelsius[i-1]);
+    rangeScale = RANGE_SCALE_Q32(speed);
+}
+
+// Publish a finished ping into the scan array; runs in interrupt context
+static void publishRange(uint8_t sensor, RANGE_STATE state, uint32_t mm)
+{
+    uint32_t filtered = emaFilter(&rangeSmooth[sensor], hampelFilter(&rangeGate[sensor], mm));
+
+    rangeSeq[sensor]++;
+    rangeLatest[sensor].mm = mm;
+    rangeLatest[sensor].filtered = filtered;
+    rangeLatest[sensor].time = getTicks();
+    rangeLatest[sensor].valid = (state == RANGE_DONE);
+    rangeSeq[sensor]++;
+}
+
+static void scheduleNextGroup();
+
+static void finishRanging(uint8_t sensor, RANGE_STATE state, uint32_t mm)
+{
+    rangeResult[sensor] = mm;
+    rangeState[sensor] = state;
+    if(state != RANGE_CLEAR)
+        publishRange(sensor, state, mm);
+    if(pingGate[sensor])
+    {
+        if(state == RANGE_DONE)
+            proximity[sensor] = PROXIMITY_HIT;
+        else if(state == RANGE_CLEAR)
+            proximity[sensor] = PROXIMITY_CLEAR;
+        else
+            proximity[sensor] = PROXIMITY_UNKNOWN;
+    }
+    if(rangeCallback)
+        rangeCallback(sensor, state, mm);
+
+    if(groupPending & (1 << sensor))
+    {
+        groupPending &= ~(1 << sensor);
+        if(groupPending == 0 && serviceRunning)
+            scheduleNextGroup();
+    }
+}
+
+// Arm the engine for a new ping of one sensor
+void rangingTrigger(uint8_t sensor, uint32_t now)
+{
+    riseSeen[sensor] = false;
+    pingGate[sensor] = gateTicks[sensor];
+    rangeDeadline[sensor] = now + RANGE_TIMEOUT_US * TICKS_PER_US;
+    rangeState[sensor] = RANGE_BUSY;
+}
+
+// Feed one captured echo edge into the engine
+void rangingEdge(uint8_t sensor, uint32_t capture, bool rising)
+{
+    if(rangeState[sensor] != RANGE_BUSY)
+        return;
+
+    if(rising)
+    {
+        riseTime[sensor] = capture;
+        riseSeen[sensor] = true;
+        if(pingGate[sensor])
+            rangeDeadline[sensor] = getTicks() + pingGate[sensor];  // resolve once the gate distance has passed
+    }
+    else if(riseSeen[sensor])
+    {
+        finishRanging(sensor, RANGE_DONE,
+                      rangeTicksToMm((capture - riseTime[sensor]) & rangeSensors[sensor].captureMask));
+    }
+}
+
+// Abandon every ping whose echo did not come back in time; a gated ping
+// that saw its echo start is clear of anything inside the gate
+void rangingDeadline(uint32_t now)
+{
+    uint8_t i;
+
+    for(i = 0; i < RANGE_SENSOR_COUNT; i++)
+    {
+        if(rangeState[i] == RANGE_BUSY && (int32_t)(now - rangeDeadline[i]) >= 0)
+        {
+            if(pingGate[i] && riseSeen[i])
+                finishRanging(i, RANGE_CLEAR, RANGE_MAX_MM);
+            else
+                finishRanging(i, RANGE_TIMEOUT, RANGE_MAX_MM);
+        }
+    }
+}
+
+// Make pings of a sensor resolve as soon as the echo is known to be longer
+// than thresholdMm (0 turns the gate off); results are read with getProximity()
+void setProximityGate(uint8_t sensor, uint32_t thresholdMm)
+{
+    gateTicks[sensor] = thresholdMm ? rangeMmToTicks(thresholdMm) : 0;
+    proximity[sensor] = PROXIMITY_UNKNOWN;
+}
+
+PROXIMITY_STATE getProximity(uint8_t sensor)
+{
+    return proximity[sensor];
+}
+
+// Load Timer 5A for the earliest deadline of the pings in flight
+static void armDeadline()
+{
+    uint32_t now = getTicks();
+    int32_t earliest = 0x7FFFFFFF;
+    bool pending = false;
+    uint8_t i;
+
+    for(i = 0; i < RANGE_SENSOR_COUNT; i++)
+    {
+        if(rangeState[i] == RANGE_BUSY)
+        {
+            int32_t left = (int32_t)(rangeDeadline[i] - now);
+            if(left < earliest)
+                earliest = left;
+            pending = true;
+        }
+    }
+
+    TIMER5_CTL_R &= ~TIMER_CTL_TAEN;
+    if(pending)
+    {
+        if(earliest < TICKS_PER_US)
+            earliest = TICKS_PER_US;
+        TIMER5_TAILR_R = earliest;
+        TIMER5_TAV_R = earliest;
+        TIMER5_CTL_R |= TIMER_CTL_TAEN;
+    }
+}
+
+// Pulse the triggers of every idle sensor in mask, returns the sensors started
+static uint8_t triggerSensors(uint8_t mask)
+{
+    uint32_t now = getTicks();
+    uint8_t started = 0;
+    uint8_t i;
+
+    for(i = 0; i < RANGE_SENSOR_COUNT; i++)
+    {
+        if((mask & (1 << i)) && rangeState[i] != RANGE_BUSY && !*rangeSensors[i].echo)
+        {
+            rangingTrigger(i, now);
+            *rangeSensors[i].trigger = 1;
+            started |= 1 << i;
+        }
+    }
+    if(started)
+    {
+        waitMicrosecond(TRIGGER_US);
+        for(i = 0; i < RANGE_SENSOR_COUNT; i++)
+            *rangeSensors[i].trigger = 0;
+        armDeadline();
+    }
+    return started;
+}
+
+void setRangingCallback(RANGE_CALLBACK callback)
+{
+    rangeCallback = callback;
+}
+
+// Start a single ping, returns false if that sensor is still busy
+bool startRanging(uint8_t sensor)
+{
+    uint8_t started;
+
+    __asm(" CPSID I");
+    started = triggerSensors(1 << sensor);
+    __asm(" CPSIE I");
+
+    return started != 0;
+}
+
+// Returns the state of a sensor; a finished result is handed out once
+RANGE_STATE pollRanging(uint8_t sensor, uint32_t *mm)
+{
+    RANGE_STATE state = rangeState[sensor];
+
+    if(state == RANGE_DONE || state == RANGE_TIMEOUT || state == RANGE_CLEAR)
+    {
+        *mm = rangeResult[sensor];
+        rangeState[sensor] = RANGE_IDLE;
+    }
+    return state;
+}
+
+// Blocking ping of the front sensor. Waiting for the sensor to come free
+// and for its echo are each bounded by one ping slot (echo timeout plus
+// guard); returns RANGE_ERROR_MM if either runs out.
+uint32_t measure_mm()
+{
+    uint32_t start = getTicks();
+    uint32_t mm = RANGE_ERROR_MM;
+
+    while(!startRanging(RANGE_FRONT))
+        if(ticksSince(start) > RANGE_SLOT_US * TICKS_PER_US)
+            return RANGE_ERROR_MM;
+
+    start = getTicks();
+    while(pollRanging(RANGE_FRONT, &mm) == RANGE_BUSY)
+        if(ticksSince(start) > RANGE_SLOT_US * TICKS_PER_US)
+            return RANGE_ERROR_MM;
+
+    return mm;
+}
+
+// Run Timer 0A once after delay ticks
+static void scheduleIn(uint32_t delay)
+{
+    TIMER0_CTL_R &= ~TIMER_CTL_TAEN;
+    TIMER0_TAILR_R = delay;
+    TIMER0_TAV_R = delay;
+    TIMER0_CTL_R |= TIMER_CTL_TAEN;
+}
+
+// Current group is done: move on after the ring-down guard, but no sooner
+// than the configured rate allows. A group with a proximity gate is paced by
+// how fast its pings resolve, that is the point of gating them.
+static void scheduleNextGroup()
+{
+    uint32_t elapsed = ticksSince(slotStart);
+    uint32_t delay = RANGE_GUARD_US * TICKS_PER_US;
+    bool gated = false;
+    uint8_t i;
+
+    for(i = 0; i < RANGE_SENSOR_COUNT; i++)
+        if(rangeSensors[i].group == currentGroup && pingGate[i])
+            gated = true;
+
+    if(!gated && servicePeriod > elapsed && servicePeriod - elapsed > delay)
+        delay = servicePeriod - elapsed;
+
+    currentGroup++;
+    if(currentGroup >= groupCount)
+        currentGroup = 0;
+    scheduleIn(delay);
+}
+
+// Ping each sensor group in turn, at most rateHz groups per second; 0 starts
+// each group as soon as the previous one resolves and has rung down
+void startRangingService(uint32_t rateHz)
+{
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R0;
+    _delay_cycles(3);
+
+    servicePeriod = rateHz ? 40000000 / rateHz : 0;
+    currentGroup = 0;
+    groupPending = 0;
+    serviceRunning = true;
+
+    TIMER0_CTL_R &= ~TIMER_CTL_TAEN;                 // turn-off timer before reconfiguring
+    TIMER0_CFG_R = TIMER_CFG_32_BIT_TIMER;           // configure as 32-bit timer (A+B)
+    TIMER0_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;          // configure for one-shot mode (count down)
+    TIMER0_ICR_R = TIMER_ICR_TATOCINT;
+    TIMER0_IMR_R = TIMER_IMR_TATOIM;
+    NVIC_EN0_R = 1 << (INT_TIMER0A-16);              // turn-on interrupt 35 (TIMER0A)
+    scheduleIn(TICKS_PER_US);
+}
+
+void stopRangingService()
+{
+    serviceRunning = false;
+    TIMER0_CTL_R &= ~TIMER_CTL_TAEN;
+}
+
+// Copy the newest sample of a sensor without blocking the writer; returns its sequence number
+uint32_t getRange(uint8_t sensor, RANGE_SAMPLE *sample)
+{
+    uint32_t seq;
+
+    do
+    {
+        seq = rangeSeq[sensor];
+        sample->mm = rangeLatest[sensor].mm;
+        sample->filtered = rangeLatest[sensor].filtered;
+        sample->time = rangeLatest[sensor].time;
+        sample->valid = rangeLatest[sensor].valid;
+    } while((seq & 1) || seq != rangeSeq[sensor]);
+
+    return seq >> 1;
+}
+
+// Copy the newest sample of every sensor
+void getRangeScan(RANGE_SAMPLE scan[RANGE_SENSOR_COUNT])
+{
+    uint8_t i;
+
+    for(i = 0; i < RANGE_SENSOR_COUNT; i++)
+        getRange(i, &scan[i]);
+}
+
+uint32_t getRangeMm(uint8_t sensor)
+{
+    RANGE_SAMPLE sample;
+
+    getRange(sensor, &sample);
+    return sample.mm;
+}
+
+uint32_t getFilteredRangeMm(uint8_t sensor)
+{
+    RANGE_SAMPLE sample;
+
+    getRange(sensor, &sample);
+    return sample.filtered;
+}
+
+uint32_t getRangeAgeUs(const RANGE_SAMPLE *sample)
+{
+    return ticksSince(sample->time) / TICKS_PER_US;
+}
+
+void RangingServiceIsr()
+{
+    uint8_t mask = 0;
+    uint8_t i;
+
+    TIMER0_ICR_R = TIMER_ICR_TATOCINT;
+    if(!serviceRunning)
+        return;
+
+    for(i = 0; i < RANGE_SENSOR_COUNT; i++)
+        if(rangeSensors[i].group == currentGroup)
+            mask |= 1 << i;
+
+    slotStart = getTicks();
+    groupPending = triggerSensors(mask);
+    if(groupPending == 0)
+        scheduleNextGroup();                         // group busy with one-shot pings, try the next
+}
+
+static void echoCapture(uint8_t sensor)
+{
+    if(sensor >= RANGE_SENSOR_COUNT)
+        return;
+    rangingEdge(sensor, *rangeSensors[sensor].capture, *rangeSensors[sensor].echo);
+    armDeadline();
+}
+
+void FrontEchoIsr()
+{
+    TIMER3_ICR_R = TIMER_ICR_CAECINT;
+    echoCapture(RANGE_FRONT);
+}
+
+void RightEchoIsr()
+{
+    TIMER3_ICR_R = TIMER_ICR_CBECINT;
+    echoCapture(RANGE_RIGHT);
+}
+
+void BackEchoIsr()
+{
+    WTIMER4_ICR_R = TIMER_ICR_CAECINT;
+    echoCapture(RANGE_BACK);
+}
+
+void LeftEchoIsr()
+{
+    WTIMER4_ICR_R = TIMER_ICR_CBECINT;
+    echoCapture(RANGE_LEFT);
+}
+
+void RangeDeadlineIsr()
+{
+    TIMER5_ICR_R = TIMER_ICR_TATOCINT;
+    rangingDeadline(getTicks());
+    armDeadline();
+}
@@ -0,0 +1,113 @@
+// Ultrasonic Ranging Library
+// Anaf Mahbub
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Front sensor: Trigger on (PB6), Echo on T3CCP0 (PB2)
+// Right sensor: Trigger on (PB7), Echo on T3CCP1 (PB3)
+// Back sensor:  Trigger on (PB4), Echo on WT4CCP0 (PD4)
+// Left sensor:  Trigger on (PB5), Echo on WT4CCP1 (PD5)
+// Timer 3A/3B, Wide Timer 4A/4B: edge-time capture of the echo pulses
+// Timer 5A: one-shot deadline for echo timeouts
+// Timer 0A: one-shot ping scheduler for the ranging service
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef ULTRASONIC_H_
+#define ULTRASONIC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timebase.h"
+
+// Number of fitted sensors, taken in order from the pin table
+#ifndef RANGE_SENSOR_COUNT
+#define RANGE_SENSOR_COUNT 1
+#endif
+
+#define RANGE_FRONT 0
+#define RANGE_RIGHT 1
+#define RANGE_BACK 2
+#define RANGE_LEFT 3
+
+#define RANGE_TIMEOUT_US 30000                     // no echo within 30 ms (~5 m) is out of range
+#define RANGE_MAX_MM 4000                          // distance reported when no echo returns
+#define RANGE_GUARD_US 5000                        // ring-down gap before the next ping
+#define RANGE_SLOT_US (RANGE_TIMEOUT_US + RANGE_GUARD_US) // longest a single ping can take
+#define RANGE_MAX_RATE_HZ (1000000 / RANGE_SLOT_US)
+#define RANGE_ERROR_MM 0                           // measure_mm() could not get a ping out or back
+#define RANGE_SERVICE_HZ 0                         // background ping rate per group, 0 to go on each resolution
+#define RANGE_DEFAULT_CELSIUS 20                   // air temperature assumed at boot
+#define RANGE_FILTER_WINDOW 5                      // samples in the outlier gate median
+#define RANGE_FILTER_GAIN_Q4 71                    // reject beyond 3 sigma (3 * 1.4826 MAD, Q4)
+#define RANGE_FILTER_FLOOR_MM 30                   // never reject within 30 mm of the median
+#define RANGE_SMOOTH_SHIFT 1                       // exponential smoother weight 1/2
+
+// Q32 millimeters per capture tick for a speed of sound in mm/s (round trip)
+#define RANGE_SCALE_Q32(speed) ((uint32_t)((((uint64_t)(speed) << 32) + TICKS_PER_US * 1000000ULL) / (2ULL * TICKS_PER_US * 1000000ULL)))
+
+typedef enum _RANGE_STATE
+{
+    RANGE_IDLE,
+    RANGE_BUSY,
+    RANGE_DONE,
+    RANGE_TIMEOUT,
+    RANGE_CLEAR                                    // proximity gate passed without an echo
+} RANGE_STATE;
+
+typedef enum _PROXIMITY_STATE
+{
+    PROXIMITY_UNKNOWN,
+    PROXIMITY_CLEAR,                               // nothing inside the gate distance
+    PROXIMITY_HIT                                  // echo returned inside the gate distance
+} PROXIMITY_STATE;
+
+typedef struct _RANGE_SAMPLE
+{
+    uint32_t mm;                                   // distance, RANGE_MAX_MM if no echo
+    uint32_t filtered;                             // outlier-gated and smoothed distance
+    uint32_t time;                                 // timebase ticks when the ping completed
+    bool valid;                                    // false if the ping timed out
+} RANGE_SAMPLE;
+
+// Called from interrupt context when a ping completes or times out
+typedef void (*RANGE_CALLBACK)(uint8_t sensor, RANGE_STATE state, uint32_t mm);
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initRanging();
+bool startRanging(uint8_t sensor);
+RANGE_STATE pollRanging(uint8_t sensor, uint32_t *mm);
+void setRangingCallback(RANGE_CALLBACK callback);
+uint32_t measure_mm();
+uint32_t rangeTicksToMm(uint32_t ticks);
+uint32_t rangeMmToTicks(uint32_t mm);
+void setProximityGate(uint8_t sensor, uint32_t thresholdMm);
+PROXIMITY_STATE getProximity(uint8_t sensor);
+void setRangingTemperature(int16_t celsius);
+void startRangingService(uint32_t rateHz);
+void stopRangingService();
+uint32_t getRange(uint8_t sensor, RANGE_SAMPLE *sample);
+void getRangeScan(RANGE_SAMPLE scan[RANGE_SENSOR_COUNT]);
+uint32_t getRangeMm(uint8_t sensor);
+uint32_t getFilteredRangeMm(uint8_t sensor);
+uint32_t getRangeAgeUs(const RANGE_SAMPLE *sample);
+
+// Hardware independent engine, driven by the ISRs (or simulated edges on a host)
+void resetRangingEngine();
+void rangingTrigger(uint8_t sensor, uint32_t now);
+void rangingEdge(uint8_t sensor, uint32_t capture, bool rising);
+void rangingDeadline(uint32_t now);
+
+#endif